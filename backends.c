@@ -36,6 +36,7 @@ const char *ul_backends_backends[] = {
 #if USE_DRM
     "drm",
 #endif /* USE_DRM */
+    "headless",
     NULL
 };
 
@@ -37,6 +37,7 @@ typedef enum {
 #if USE_DRM
     UL_BACKENDS_BACKEND_DRM,
 #endif /* USE_DRM */
+    UL_BACKENDS_BACKEND_HEADLESS,
 } ul_backends_backend_id_t;
 
 /* Backends */
@@ -0,0 +1,330 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "blend.h"
+
+#include "cpu.h"
+
+#include <string.h>
+
+#if LV_COLOR_DEPTH == 32 && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_X86_BLENDERS 1
+#endif
+
+#if LV_COLOR_DEPTH == 32 && defined(__aarch64__)
+#include <arm_neon.h>
+#define HAVE_NEON_BLENDER 1
+#endif
+
+
+/**
+ * Defines
+ */
+
+/* Blender signature */
+typedef void (*blend_fn)(lv_color_t *dst, const lv_opa_t *mask, lv_color_t color, size_t count);
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Portable blender working on one pixel at a time.
+ *
+ * @param dst pixels to blend onto
+ * @param mask opacity of the colour for every pixel
+ * @param color colour to blend
+ * @param count number of pixels
+ */
+static void blend_scalar(lv_color_t *dst, const lv_opa_t *mask, lv_color_t color, size_t count);
+
+#if HAVE_X86_BLENDERS
+/**
+ * SSE2 blender working on 4 pixels at a time.
+ *
+ * @param dst pixels to blend onto
+ * @param mask opacity of the colour for every pixel
+ * @param color colour to blend
+ * @param count number of pixels
+ */
+static void blend_sse2(lv_color_t *dst, const lv_opa_t *mask, lv_color_t color, size_t count);
+
+/**
+ * AVX2 blender working on 8 pixels at a time.
+ *
+ * @param dst pixels to blend onto
+ * @param mask opacity of the colour for every pixel
+ * @param color colour to blend
+ * @param count number of pixels
+ */
+static void blend_avx2(lv_color_t *dst, const lv_opa_t *mask, lv_color_t color, size_t count);
+#endif /* HAVE_X86_BLENDERS */
+
+#if HAVE_NEON_BLENDER
+/**
+ * NEON blender working on 16 pixels at a time.
+ *
+ * @param dst pixels to blend onto
+ * @param mask opacity of the colour for every pixel
+ * @param color colour to blend
+ * @param count number of pixels
+ */
+static void blend_neon(lv_color_t *dst, const lv_opa_t *mask, lv_color_t color, size_t count);
+#endif /* HAVE_NEON_BLENDER */
+
+/**
+ * Blend callback of LVGL's software draw context that takes over masked solid fills.
+ *
+ * @param draw_ctx draw context
+ * @param dsc what to blend where
+ */
+static void blend_cb(lv_draw_ctx_t *draw_ctx, const lv_draw_sw_blend_dsc_t *dsc);
+
+
+/**
+ * Static variables
+ */
+
+static blend_fn blend_impl = blend_scalar;
+static const char *blend_impl_name = "scalar";
+
+
+/**
+ * Static functions
+ */
+
+static void blend_scalar(lv_color_t *dst, const lv_opa_t *mask, lv_color_t color, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (mask[i] == LV_OPA_COVER) {
+            dst[i] = color;
+        } else if (mask[i] != LV_OPA_TRANSP) {
+            dst[i] = lv_color_mix(color, dst[i], mask[i]);
+        }
+    }
+}
+
+/* All SIMD blenders compute (color * mask + dst * (255 - mask)) / 255 per channel, rounding down like lv_color_mix.
+ * Runs of fully transparent or fully opaque mask values, which make up most of a glyph, skip the arithmetic. */
+
+#if HAVE_X86_BLENDERS
+__attribute__((target("sse2")))
+static void blend_sse2(lv_color_t *dst, const lv_opa_t *mask, lv_color_t color, size_t count) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i color_4 = _mm_set1_epi32((int)color.full);
+    const __m128i color_16 = _mm_unpacklo_epi8(color_4, zero);
+    const __m128i max = _mm_set1_epi16(255);
+    /* x / 255 == (x * 0x8081) >> 23 for 16 bit x */
+    const __m128i div_255 = _mm_set1_epi16((short)0x8081);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint32_t mask_4;
+        memcpy(&mask_4, mask + i, sizeof(mask_4));
+        if (mask_4 == 0) {
+            continue;
+        }
+        if (mask_4 == UINT32_MAX) {
+            _mm_storeu_si128((__m128i *)(dst + i), color_4);
+            continue;
+        }
+
+        /* Spread every mask value over the four channels of its pixel */
+        __m128i m = _mm_cvtsi32_si128((int)mask_4);
+        m = _mm_unpacklo_epi8(m, m);
+        m = _mm_unpacklo_epi16(m, m);
+        const __m128i m_lo = _mm_unpacklo_epi8(m, zero);
+        const __m128i m_hi = _mm_unpackhi_epi8(m, zero);
+
+        const __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(color_16, m_lo),
+            _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_sub_epi16(max, m_lo)));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(color_16, m_hi),
+            _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_sub_epi16(max, m_hi)));
+        lo = _mm_srli_epi16(_mm_mulhi_epu16(lo, div_255), 7);
+        hi = _mm_srli_epi16(_mm_mulhi_epu16(hi, div_255), 7);
+
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+
+    blend_scalar(dst + i, mask + i, color, count - i);
+}
+
+__attribute__((target("avx2")))
+static void blend_avx2(lv_color_t *dst, const lv_opa_t *mask, lv_color_t color, size_t count) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i color_8 = _mm256_set1_epi32((int)color.full);
+    const __m256i color_16 = _mm256_unpacklo_epi8(color_8, zero);
+    const __m256i max = _mm256_set1_epi16(255);
+    const __m256i div_255 = _mm256_set1_epi16((short)0x8081);
+    const __m256i spread = _mm256_set1_epi32(0x01010101);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint64_t mask_8;
+        memcpy(&mask_8, mask + i, sizeof(mask_8));
+        if (mask_8 == 0) {
+            continue;
+        }
+        if (mask_8 == UINT64_MAX) {
+            _mm256_storeu_si256((__m256i *)(dst + i), color_8);
+            continue;
+        }
+
+        /* Spread every mask value over the four channels of its pixel */
+        __m256i m = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(mask + i)));
+        m = _mm256_mullo_epi32(m, spread);
+        const __m256i m_lo = _mm256_unpacklo_epi8(m, zero);
+        const __m256i m_hi = _mm256_unpackhi_epi8(m, zero);
+
+        /* Unpacking works within 128 bit lanes, which the pack at the end undoes */
+        const __m256i d = _mm256_loadu_si256((const __m256i *)(dst + i));
+        __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(color_16, m_lo),
+            _mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), _mm256_sub_epi16(max, m_lo)));
+        __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(color_16, m_hi),
+            _mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), _mm256_sub_epi16(max, m_hi)));
+        lo = _mm256_srli_epi16(_mm256_mulhi_epu16(lo, div_255), 7);
+        hi = _mm256_srli_epi16(_mm256_mulhi_epu16(hi, div_255), 7);
+
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_packus_epi16(lo, hi));
+    }
+
+    blend_sse2(dst + i, mask + i, color, count - i);
+}
+#endif /* HAVE_X86_BLENDERS */
+
+#if HAVE_NEON_BLENDER
+static void blend_neon(lv_color_t *dst, const lv_opa_t *mask, lv_color_t color, size_t count) {
+    const uint8x16_t channels[4] = {
+        vdupq_n_u8(color.ch.blue), vdupq_n_u8(color.ch.green), vdupq_n_u8(color.ch.red), vdupq_n_u8(color.ch.alpha)
+    };
+    const uint16x8_t one = vdupq_n_u16(1);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16_t m = vld1q_u8(mask + i);
+        if (vmaxvq_u8(m) == LV_OPA_TRANSP) {
+            continue;
+        }
+        const uint8x16_t inv = vmvnq_u8(m);
+        if (vmaxvq_u8(inv) == 0) {
+            uint8x16x4_t solid = { { channels[0], channels[1], channels[2], channels[3] } };
+            vst4q_u8((uint8_t *)(dst + i), solid);
+            continue;
+        }
+
+        /* Split the pixels into one vector per channel */
+        uint8x16x4_t d = vld4q_u8((const uint8_t *)(dst + i));
+        for (int c = 0; c < 4; ++c) {
+            uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(channels[c]), vget_low_u8(m)), vget_low_u8(d.val[c]),
+                vget_low_u8(inv));
+            uint16x8_t hi = vmlal_u8(vmull_u8(vget_high_u8(channels[c]), vget_high_u8(m)), vget_high_u8(d.val[c]),
+                vget_high_u8(inv));
+            /* x / 255 == (x + (x >> 8) + 1) >> 8 for x <= 255 * 255 */
+            lo = vaddq_u16(vaddq_u16(lo, vshrq_n_u16(lo, 8)), one);
+            hi = vaddq_u16(vaddq_u16(hi, vshrq_n_u16(hi, 8)), one);
+            d.val[c] = vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8));
+        }
+        vst4q_u8((uint8_t *)(dst + i), d);
+    }
+
+    blend_scalar(dst + i, mask + i, color, count - i);
+}
+#endif /* HAVE_NEON_BLENDER */
+
+static void blend_cb(lv_draw_ctx_t *draw_ctx, const lv_draw_sw_blend_dsc_t *dsc) {
+    /* Only a solid colour through a partial mask at full opacity is handled here */
+    if (dsc->src_buf || !dsc->mask_buf || dsc->mask_res != LV_DRAW_MASK_RES_CHANGED || dsc->opa < LV_OPA_MAX
+        || dsc->blend_mode != LV_BLEND_MODE_NORMAL) {
+        lv_draw_sw_blend_basic(draw_ctx, dsc);
+        return;
+    }
+
+    lv_area_t blend_area;
+    if (!_lv_area_intersect(&blend_area, dsc->blend_area, draw_ctx->clip_area)) {
+        return;
+    }
+
+    const lv_area_t *buf_area = draw_ctx->buf_area;
+    const lv_coord_t dst_stride = lv_area_get_width(buf_area);
+    const lv_coord_t mask_stride = lv_area_get_width(dsc->mask_area);
+    const size_t width = (size_t)lv_area_get_width(&blend_area);
+
+    lv_color_t *dst = (lv_color_t *)draw_ctx->buf + (blend_area.y1 - buf_area->y1) * dst_stride
+        + (blend_area.x1 - buf_area->x1);
+    const lv_opa_t *mask = dsc->mask_buf + (blend_area.y1 - dsc->mask_area->y1) * mask_stride
+        + (blend_area.x1 - dsc->mask_area->x1);
+
+    for (lv_coord_t y = blend_area.y1; y <= blend_area.y2; ++y) {
+        blend_impl(dst, mask, dsc->color, width);
+        dst += dst_stride;
+        mask += mask_stride;
+    }
+}
+
+
+/**
+ * Public functions
+ */
+
+void ul_blend_init(void) {
+#if HAVE_X86_BLENDERS
+    if (ul_cpu_has_feature(UL_CPU_FEATURE_AVX2)) {
+        blend_impl = blend_avx2;
+        blend_impl_name = "avx2";
+        return;
+    }
+    if (ul_cpu_has_feature(UL_CPU_FEATURE_SSE2)) {
+        blend_impl = blend_sse2;
+        blend_impl_name = "sse2";
+        return;
+    }
+#endif /* HAVE_X86_BLENDERS */
+#if HAVE_NEON_BLENDER
+    if (ul_cpu_has_feature(UL_CPU_FEATURE_NEON)) {
+        blend_impl = blend_neon;
+        blend_impl_name = "neon";
+        return;
+    }
+#endif /* HAVE_NEON_BLENDER */
+    blend_impl = blend_scalar;
+    blend_impl_name = "scalar";
+}
+
+const char *ul_blend_get_implementation_name(void) {
+    return blend_impl_name;
+}
+
+void ul_blend_mask_solid(lv_color_t *dst, const lv_opa_t *mask, lv_color_t color, size_t count) {
+    blend_impl(dst, mask, color, count);
+}
+
+void ul_blend_set_up_display(lv_disp_t *disp) {
+    lv_disp_drv_t *disp_drv = disp->driver;
+
+    /* Pixels written through set_px_cb or onto a transparent screen do not form a plain lv_color_t array */
+    if (disp_drv->draw_ctx_init != lv_draw_sw_init_ctx || disp_drv->set_px_cb || disp_drv->screen_transp) {
+        return;
+    }
+
+    ((lv_draw_sw_ctx_t *)disp_drv->draw_ctx)->blend = blend_cb;
+}
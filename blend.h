@@ -0,0 +1,60 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef UL_BLEND_H
+#define UL_BLEND_H
+
+#include "lvgl/lvgl.h"
+
+#include <stddef.h>
+
+/**
+ * Pick the fastest blending implementation for the running CPU. Must be called before any other thread is started,
+ * calling it again is harmless.
+ */
+void ul_blend_init(void);
+
+/**
+ * Get the name of the blending implementation in use, for logging.
+ *
+ * @return implementation name
+ */
+const char *ul_blend_get_implementation_name(void);
+
+/**
+ * Blend a solid colour through an opacity mask onto a row of pixels, e.g. to draw anti-aliased text.
+ *
+ * @param dst pixels to blend onto
+ * @param mask opacity of the colour for every pixel
+ * @param color colour to blend
+ * @param count number of pixels
+ */
+void ul_blend_mask_solid(lv_color_t *dst, const lv_opa_t *mask, lv_color_t color, size_t count);
+
+/**
+ * Let LVGL's software renderer blend masked solid colours, which is how it draws every glyph and anti-aliased edge,
+ * with ul_blend_mask_solid. Everything else still goes through LVGL's own blending.
+ *
+ * @param disp registered display
+ */
+void ul_blend_set_up_display(lv_disp_t *disp);
+
+#endif /* UL_BLEND_H */
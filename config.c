@@ -21,6 +21,7 @@
 #include "config.h"
 
 #include "log.h"
+#include "pool.h"
 
 #include "lvgl/lvgl.h"
 
@@ -78,6 +79,12 @@ static void init_opts(ul_config_opts *opts) {
     opts->general.animations = false;
     opts->general.backend = ul_backends_backends[0] == NULL ? UL_BACKENDS_BACKEND_NONE : 0;
     opts->general.timeout = 0;
+    opts->general.rotation = LV_DISP_ROT_NONE;
+    opts->terminal.scrollback_lines = 10000;
+    opts->display.render_threads = 0;
+    opts->display.row_cache_kb = 16384;
+    opts->headless.dump = NULL;
+    opts->drm.buffers = 2;
     opts->keyboard.autohide = true;
     opts->keyboard.layout_id = SQ2LV_LAYOUT_US;
     opts->keyboard.popovers = false;
@@ -114,6 +121,41 @@ static int parsing_handler(void* user_data, const char* section, const char* key
             /* Use a max ceiling of 60 minutes (3600 secs) */
             opts->general.timeout = (uint16_t)LV_MIN(strtoul(value, (char **)NULL, 10), 3600);
             return 1;
+        } else if (strcmp(key, "rotation") == 0) {
+            /* Only quarter turns are supported */
+            const unsigned long degrees = strtoul(value, (char **)NULL, 10);
+            if (degrees % 90 == 0 && degrees < 360) {
+                opts->general.rotation = (lv_disp_rot_t)(degrees / 90);
+                return 1;
+            }
+        }
+    } else if (strcmp(section, "terminal") == 0) {
+        if (strcmp(key, "scrollback_lines") == 0) {
+            /* Use a max ceiling of 1 million lines */
+            opts->terminal.scrollback_lines = (uint32_t)LV_MIN(strtoul(value, (char **)NULL, 10), 1000000);
+            return 1;
+        }
+    } else if (strcmp(section, "display") == 0) {
+        if (strcmp(key, "render_threads") == 0) {
+            opts->display.render_threads = (int)LV_MIN(strtoul(value, (char **)NULL, 10), UL_POOL_MAX_THREADS);
+            return 1;
+        } else if (strcmp(key, "row_cache_kb") == 0) {
+            /* Use a max ceiling of 1 GiB */
+            opts->display.row_cache_kb = (uint32_t)LV_MIN(strtoul(value, (char **)NULL, 10), 1024 * 1024);
+            return 1;
+        }
+    } else if (strcmp(section, "headless") == 0) {
+        if (strcmp(key, "dump") == 0) {
+            char *dump = strdup(value);
+            if (dump) {
+                opts->headless.dump = dump;
+                return 1;
+            }
+        }
+    } else if (strcmp(section, "drm") == 0) {
+        if (strcmp(key, "buffers") == 0) {
+            opts->drm.buffers = (int)LV_MIN(strtoul(value, (char **)NULL, 10), 3);
+            return 1;
         }
     } else if (strcmp(section, "keyboard") == 0) {
         if (strcmp(key, "autohide") == 0) {
@@ -27,6 +27,8 @@
 
 #include "sq2lv_layouts.h"
 
+#include "lvgl/lvgl.h"
+
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -40,8 +42,44 @@ typedef struct {
     bool animations;
     /* Timeout (in seconds) - once elapsed, the device will shutdown. 0 (default) to disable */
     uint16_t timeout;
+    /* Counter-clockwise rotation of the image on the panel. LV_DISP_ROT_NONE (default) to disable */
+    lv_disp_rot_t rotation;
 } ul_config_opts_general;
 
+/**
+ * Options related to the terminal
+ */
+typedef struct {
+    /* Maximum number of lines kept after they scrolled off the screen. 0 to disable. */
+    uint32_t scrollback_lines;
+} ul_config_opts_terminal;
+
+/**
+ * Options related to rendering
+ */
+typedef struct {
+    /* Number of threads that draw the terminal, including the main thread. 0 (default) for one per core, at most 4. */
+    int render_threads;
+    /* Memory for caching rendered terminal rows in KiB, 0 disables the cache. Defaults to 16384. */
+    uint32_t row_cache_kb;
+} ul_config_opts_display;
+
+/**
+ * Options related to the headless backend
+ */
+typedef struct {
+    /* File to write every rendered frame to, NULL (default) to not dump frames */
+    const char *dump;
+} ul_config_opts_headless;
+
+/**
+ * Options related to the DRM backend
+ */
+typedef struct {
+    /* Number of scanout buffers to flip between (2 or 3). 0 or 1 to draw into a single buffer without page flips. */
+    int buffers;
+} ul_config_opts_drm;
+
 /**
  * Options related to the keyboard
  */
@@ -92,6 +130,14 @@ typedef struct {
 typedef struct {
     /* General options */
     ul_config_opts_general general;
+    /* Options related to the terminal */
+    ul_config_opts_terminal terminal;
+    /* Options related to rendering */
+    ul_config_opts_display display;
+    /* Options related to the headless backend */
+    ul_config_opts_headless headless;
+    /* Options related to the DRM backend */
+    ul_config_opts_drm drm;
     /* Options related to the keyboard */
     ul_config_opts_keyboard keyboard;
     /* Options related to the password textarea */
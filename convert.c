@@ -0,0 +1,489 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "convert.h"
+
+#include "cpu.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#if LV_COLOR_DEPTH == 32 && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_X86_CONVERTERS 1
+#endif
+
+#if LV_COLOR_DEPTH == 32 && defined(__aarch64__)
+#include <arm_neon.h>
+#define HAVE_NEON_CONVERTERS 1
+#endif
+
+
+/**
+ * Defines
+ */
+
+/* Converter signature. Converters for BGR formats store the red channel where RGB formats store blue. Converting
+ * lv_color_t into its own format is a plain copy and never goes through a converter. */
+typedef void (*convert_fn)(uint8_t *dst, const lv_color_t *src, size_t count, bool is_bgr);
+
+/* Properties of a scanout format */
+typedef struct {
+    const char *name;
+    size_t bytes_per_pixel;
+    bool is_bgr;
+} format_info;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Portable converter to 32 bit pixels working on one pixel at a time.
+ *
+ * @param dst pixels to write
+ * @param src pixels to read
+ * @param count number of pixels
+ * @param is_bgr true to write XBGR8888, false for XRGB8888
+ */
+static void convert_32_scalar(uint8_t *dst, const lv_color_t *src, size_t count, bool is_bgr);
+
+/**
+ * Portable converter to 24 bit pixels working on one pixel at a time.
+ *
+ * @param dst pixels to write
+ * @param src pixels to read
+ * @param count number of pixels
+ * @param is_bgr true to write BGR888, false for RGB888
+ */
+static void convert_24_scalar(uint8_t *dst, const lv_color_t *src, size_t count, bool is_bgr);
+
+/**
+ * Portable converter to 16 bit pixels working on one pixel at a time.
+ *
+ * @param dst pixels to write
+ * @param src pixels to read
+ * @param count number of pixels
+ * @param is_bgr true to write BGR565, false for RGB565
+ */
+static void convert_16_scalar(uint8_t *dst, const lv_color_t *src, size_t count, bool is_bgr);
+
+#if HAVE_X86_CONVERTERS
+/**
+ * SSE2 converter to 32 bit pixels working on 4 pixels at a time.
+ *
+ * @param dst pixels to write
+ * @param src pixels to read
+ * @param count number of pixels
+ * @param is_bgr must be true, XRGB8888 is LVGL's own format and only ever copied
+ */
+static void convert_32_sse2(uint8_t *dst, const lv_color_t *src, size_t count, bool is_bgr);
+
+/**
+ * AVX2 converter to 32 bit pixels working on 8 pixels at a time.
+ *
+ * @param dst pixels to write
+ * @param src pixels to read
+ * @param count number of pixels
+ * @param is_bgr must be true, XRGB8888 is LVGL's own format and only ever copied
+ */
+static void convert_32_avx2(uint8_t *dst, const lv_color_t *src, size_t count, bool is_bgr);
+
+/**
+ * SSSE3 converter to 24 bit pixels working on 4 pixels at a time.
+ *
+ * @param dst pixels to write
+ * @param src pixels to read
+ * @param count number of pixels
+ * @param is_bgr true to write BGR888, false for RGB888
+ */
+static void convert_24_ssse3(uint8_t *dst, const lv_color_t *src, size_t count, bool is_bgr);
+
+/**
+ * SSE2 converter to 16 bit pixels working on 8 pixels at a time.
+ *
+ * @param dst pixels to write
+ * @param src pixels to read
+ * @param count number of pixels
+ * @param is_bgr true to write BGR565, false for RGB565
+ */
+static void convert_16_sse2(uint8_t *dst, const lv_color_t *src, size_t count, bool is_bgr);
+
+/**
+ * AVX2 converter to 16 bit pixels working on 16 pixels at a time.
+ *
+ * @param dst pixels to write
+ * @param src pixels to read
+ * @param count number of pixels
+ * @param is_bgr true to write BGR565, false for RGB565
+ */
+static void convert_16_avx2(uint8_t *dst, const lv_color_t *src, size_t count, bool is_bgr);
+#endif /* HAVE_X86_CONVERTERS */
+
+#if HAVE_NEON_CONVERTERS
+/**
+ * NEON converter to 32 bit pixels working on 16 pixels at a time.
+ *
+ * @param dst pixels to write
+ * @param src pixels to read
+ * @param count number of pixels
+ * @param is_bgr must be true, XRGB8888 is LVGL's own format and only ever copied
+ */
+static void convert_32_neon(uint8_t *dst, const lv_color_t *src, size_t count, bool is_bgr);
+
+/**
+ * NEON converter to 24 bit pixels working on 16 pixels at a time.
+ *
+ * @param dst pixels to write
+ * @param src pixels to read
+ * @param count number of pixels
+ * @param is_bgr true to write BGR888, false for RGB888
+ */
+static void convert_24_neon(uint8_t *dst, const lv_color_t *src, size_t count, bool is_bgr);
+
+/**
+ * NEON converter to 16 bit pixels working on 8 pixels at a time.
+ *
+ * @param dst pixels to write
+ * @param src pixels to read
+ * @param count number of pixels
+ * @param is_bgr true to write BGR565, false for RGB565
+ */
+static void convert_16_neon(uint8_t *dst, const lv_color_t *src, size_t count, bool is_bgr);
+#endif /* HAVE_NEON_CONVERTERS */
+
+
+/**
+ * Static variables
+ */
+
+static const format_info formats[UL_CONVERT_FORMAT_COUNT] = {
+    [UL_CONVERT_FORMAT_UNKNOWN] = { "unknown", 0, false },
+    [UL_CONVERT_FORMAT_XRGB8888] = { "XRGB8888", 4, false },
+    [UL_CONVERT_FORMAT_XBGR8888] = { "XBGR8888", 4, true },
+    [UL_CONVERT_FORMAT_RGB888] = { "RGB888", 3, false },
+    [UL_CONVERT_FORMAT_BGR888] = { "BGR888", 3, true },
+    [UL_CONVERT_FORMAT_RGB565] = { "RGB565", 2, false },
+    [UL_CONVERT_FORMAT_BGR565] = { "BGR565", 2, true }
+};
+
+static convert_fn convert_32_impl = convert_32_scalar;
+static convert_fn convert_24_impl = convert_24_scalar;
+static convert_fn convert_16_impl = convert_16_scalar;
+static const char *convert_impl_name = "scalar";
+
+
+/**
+ * Static functions
+ */
+
+static void convert_32_scalar(uint8_t *dst, const lv_color_t *src, size_t count, bool is_bgr) {
+    for (size_t i = 0; i < count; ++i) {
+        lv_color32_t c;
+        c.full = lv_color_to32(src[i]);
+        dst[4 * i] = is_bgr ? c.ch.red : c.ch.blue;
+        dst[4 * i + 1] = c.ch.green;
+        dst[4 * i + 2] = is_bgr ? c.ch.blue : c.ch.red;
+        dst[4 * i + 3] = c.ch.alpha;
+    }
+}
+
+static void convert_24_scalar(uint8_t *dst, const lv_color_t *src, size_t count, bool is_bgr) {
+    for (size_t i = 0; i < count; ++i) {
+        lv_color32_t c;
+        c.full = lv_color_to32(src[i]);
+        dst[3 * i] = is_bgr ? c.ch.red : c.ch.blue;
+        dst[3 * i + 1] = c.ch.green;
+        dst[3 * i + 2] = is_bgr ? c.ch.blue : c.ch.red;
+    }
+}
+
+static void convert_16_scalar(uint8_t *dst, const lv_color_t *src, size_t count, bool is_bgr) {
+    for (size_t i = 0; i < count; ++i) {
+        lv_color32_t c;
+        c.full = lv_color_to32(src[i]);
+        const uint16_t first = is_bgr ? c.ch.blue : c.ch.red;
+        const uint16_t last = is_bgr ? c.ch.red : c.ch.blue;
+        const uint16_t pixel = (uint16_t)(((first >> 3) << 11) | ((c.ch.green >> 2) << 5) | (last >> 3));
+        memcpy(dst + 2 * i, &pixel, sizeof(pixel));
+    }
+}
+
+/* The SIMD converters read lv_color_t as little endian 0xAARRGGBB words. Unused bits of 32 bit formats receive the
+ * alpha channel, which LVGL keeps opaque. */
+
+#if HAVE_X86_CONVERTERS
+__attribute__((target("sse2")))
+static void convert_32_sse2(uint8_t *dst, const lv_color_t *src, size_t count, bool is_bgr) {
+    const __m128i green_alpha = _mm_set1_epi32((int)0xff00ff00);
+    const __m128i red = _mm_set1_epi32(0x00ff0000);
+    const __m128i blue = _mm_set1_epi32(0x000000ff);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i p = _mm_loadu_si128((const __m128i *)(src + i));
+        const __m128i swapped = _mm_or_si128(_mm_and_si128(p, green_alpha),
+            _mm_or_si128(_mm_and_si128(_mm_slli_epi32(p, 16), red), _mm_and_si128(_mm_srli_epi32(p, 16), blue)));
+        _mm_storeu_si128((__m128i *)(dst + 4 * i), swapped);
+    }
+
+    convert_32_scalar(dst + 4 * i, src + i, count - i, is_bgr);
+}
+
+__attribute__((target("avx2")))
+static void convert_32_avx2(uint8_t *dst, const lv_color_t *src, size_t count, bool is_bgr) {
+    /* Exchange bytes 0 and 2 of every pixel */
+    const __m256i order = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i p = _mm256_loadu_si256((const __m256i *)(src + i));
+        _mm256_storeu_si256((__m256i *)(dst + 4 * i), _mm256_shuffle_epi8(p, order));
+    }
+
+    convert_32_sse2(dst + 4 * i, src + i, count - i, is_bgr);
+}
+
+__attribute__((target("ssse3")))
+static void convert_24_ssse3(uint8_t *dst, const lv_color_t *src, size_t count, bool is_bgr) {
+    /* Drop the alpha byte of 4 pixels into the low 12 bytes */
+    const __m128i order = is_bgr
+        ? _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)
+        : _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+    /* Every store writes 16 bytes of which the last 4 are overwritten by the next one, so stop while the store
+     * still fits into the row */
+    size_t i = 0;
+    for (; i + 6 <= count; i += 4) {
+        const __m128i p = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_si128((__m128i *)(dst + 3 * i), _mm_shuffle_epi8(p, order));
+    }
+
+    convert_24_scalar(dst + 3 * i, src + i, count - i, is_bgr);
+}
+
+__attribute__((target("sse2")))
+static void convert_16_sse2(uint8_t *dst, const lv_color_t *src, size_t count, bool is_bgr) {
+    const __m128i high_5 = _mm_set1_epi32(0xf800);
+    const __m128i middle_6 = _mm_set1_epi32(0x07e0);
+    const __m128i low_5 = _mm_set1_epi32(0x001f);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i packed[2];
+        for (int half = 0; half < 2; ++half) {
+            const __m128i p = _mm_loadu_si128((const __m128i *)(src + i + 4 * half));
+            const __m128i green = _mm_and_si128(_mm_srli_epi32(p, 5), middle_6);
+            const __m128i first = is_bgr ? _mm_slli_epi32(p, 8) : _mm_srli_epi32(p, 8);
+            const __m128i last = is_bgr ? _mm_srli_epi32(p, 19) : _mm_srli_epi32(p, 3);
+            const __m128i pixel = _mm_or_si128(_mm_or_si128(_mm_and_si128(first, high_5), green),
+                _mm_and_si128(last, low_5));
+            /* Sign extend so that the saturating pack keeps all 16 bits */
+            packed[half] = _mm_srai_epi32(_mm_slli_epi32(pixel, 16), 16);
+        }
+        _mm_storeu_si128((__m128i *)(dst + 2 * i), _mm_packs_epi32(packed[0], packed[1]));
+    }
+
+    convert_16_scalar(dst + 2 * i, src + i, count - i, is_bgr);
+}
+
+__attribute__((target("avx2")))
+static void convert_16_avx2(uint8_t *dst, const lv_color_t *src, size_t count, bool is_bgr) {
+    const __m256i high_5 = _mm256_set1_epi32(0xf800);
+    const __m256i middle_6 = _mm256_set1_epi32(0x07e0);
+    const __m256i low_5 = _mm256_set1_epi32(0x001f);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i packed[2];
+        for (int half = 0; half < 2; ++half) {
+            const __m256i p = _mm256_loadu_si256((const __m256i *)(src + i + 8 * half));
+            const __m256i green = _mm256_and_si256(_mm256_srli_epi32(p, 5), middle_6);
+            const __m256i first = is_bgr ? _mm256_slli_epi32(p, 8) : _mm256_srli_epi32(p, 8);
+            const __m256i last = is_bgr ? _mm256_srli_epi32(p, 19) : _mm256_srli_epi32(p, 3);
+            const __m256i pixel = _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(first, high_5), green),
+                _mm256_and_si256(last, low_5));
+            packed[half] = _mm256_srai_epi32(_mm256_slli_epi32(pixel, 16), 16);
+        }
+        /* Packing works within 128 bit lanes, put the quarters back in order */
+        const __m256i pixels = _mm256_permute4x64_epi64(_mm256_packs_epi32(packed[0], packed[1]), 0xd8);
+        _mm256_storeu_si256((__m256i *)(dst + 2 * i), pixels);
+    }
+
+    convert_16_sse2(dst + 2 * i, src + i, count - i, is_bgr);
+}
+#endif /* HAVE_X86_CONVERTERS */
+
+#if HAVE_NEON_CONVERTERS
+static void convert_32_neon(uint8_t *dst, const lv_color_t *src, size_t count, bool is_bgr) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x4_t p = vld4q_u8((const uint8_t *)(src + i));
+        const uint8x16_t blue = p.val[0];
+        p.val[0] = p.val[2];
+        p.val[2] = blue;
+        vst4q_u8(dst + 4 * i, p);
+    }
+
+    convert_32_scalar(dst + 4 * i, src + i, count - i, is_bgr);
+}
+
+static void convert_24_neon(uint8_t *dst, const lv_color_t *src, size_t count, bool is_bgr) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16x4_t p = vld4q_u8((const uint8_t *)(src + i));
+        uint8x16x3_t out = { { p.val[0], p.val[1], p.val[2] } };
+        if (is_bgr) {
+            out.val[0] = p.val[2];
+            out.val[2] = p.val[0];
+        }
+        vst3q_u8(dst + 3 * i, out);
+    }
+
+    convert_24_scalar(dst + 3 * i, src + i, count - i, is_bgr);
+}
+
+static void convert_16_neon(uint8_t *dst, const lv_color_t *src, size_t count, bool is_bgr) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const uint8x8x4_t p = vld4_u8((const uint8_t *)(src + i));
+        const uint8x8_t first = is_bgr ? p.val[0] : p.val[2];
+        const uint8x8_t last = is_bgr ? p.val[2] : p.val[0];
+        /* Shift the channels in from the top, keeping the upper bits of each */
+        uint16x8_t pixels = vshll_n_u8(first, 8);
+        pixels = vsriq_n_u16(pixels, vshll_n_u8(p.val[1], 8), 5);
+        pixels = vsriq_n_u16(pixels, vshll_n_u8(last, 8), 11);
+        vst1q_u16((uint16_t *)(dst + 2 * i), pixels);
+    }
+
+    convert_16_scalar(dst + 2 * i, src + i, count - i, is_bgr);
+}
+#endif /* HAVE_NEON_CONVERTERS */
+
+
+/**
+ * Public functions
+ */
+
+void ul_convert_init(void) {
+    convert_32_impl = convert_32_scalar;
+    convert_24_impl = convert_24_scalar;
+    convert_16_impl = convert_16_scalar;
+    convert_impl_name = "scalar";
+
+#if HAVE_X86_CONVERTERS
+    if (ul_cpu_has_feature(UL_CPU_FEATURE_SSE2)) {
+        convert_32_impl = convert_32_sse2;
+        convert_16_impl = convert_16_sse2;
+        convert_impl_name = "sse2";
+    }
+    if (ul_cpu_has_feature(UL_CPU_FEATURE_SSSE3)) {
+        convert_24_impl = convert_24_ssse3;
+        convert_impl_name = "ssse3";
+    }
+    if (ul_cpu_has_feature(UL_CPU_FEATURE_AVX2)) {
+        convert_32_impl = convert_32_avx2;
+        convert_16_impl = convert_16_avx2;
+        convert_impl_name = "avx2";
+    }
+#endif /* HAVE_X86_CONVERTERS */
+#if HAVE_NEON_CONVERTERS
+    if (ul_cpu_has_feature(UL_CPU_FEATURE_NEON)) {
+        convert_32_impl = convert_32_neon;
+        convert_24_impl = convert_24_neon;
+        convert_16_impl = convert_16_neon;
+        convert_impl_name = "neon";
+    }
+#endif /* HAVE_NEON_CONVERTERS */
+}
+
+const char *ul_convert_get_implementation_name(void) {
+    return convert_impl_name;
+}
+
+ul_convert_format ul_convert_get_native_format(void) {
+#if LV_COLOR_DEPTH == 32
+    return UL_CONVERT_FORMAT_XRGB8888;
+#elif LV_COLOR_DEPTH == 16 && !LV_COLOR_16_SWAP
+    return UL_CONVERT_FORMAT_RGB565;
+#else
+    return UL_CONVERT_FORMAT_UNKNOWN;
+#endif
+}
+
+ul_convert_format ul_convert_find_format(uint32_t bits_per_pixel, uint32_t red_offset, uint32_t green_offset,
+    uint32_t blue_offset) {
+    if ((bits_per_pixel == 32 || bits_per_pixel == 24) && green_offset == 8) {
+        if (red_offset == 16 && blue_offset == 0) {
+            return bits_per_pixel == 32 ? UL_CONVERT_FORMAT_XRGB8888 : UL_CONVERT_FORMAT_RGB888;
+        }
+        if (red_offset == 0 && blue_offset == 16) {
+            return bits_per_pixel == 32 ? UL_CONVERT_FORMAT_XBGR8888 : UL_CONVERT_FORMAT_BGR888;
+        }
+    }
+    if (bits_per_pixel == 16 && green_offset == 5) {
+        if (red_offset == 11 && blue_offset == 0) {
+            return UL_CONVERT_FORMAT_RGB565;
+        }
+        if (red_offset == 0 && blue_offset == 11) {
+            return UL_CONVERT_FORMAT_BGR565;
+        }
+    }
+    return UL_CONVERT_FORMAT_UNKNOWN;
+}
+
+size_t ul_convert_get_bytes_per_pixel(ul_convert_format format) {
+    return formats[format].bytes_per_pixel;
+}
+
+const char *ul_convert_get_format_name(ul_convert_format format) {
+    return formats[format].name;
+}
+
+void ul_convert_area(ul_convert_format format, void *dst, size_t dst_stride, const lv_color_t *src, size_t src_stride,
+    size_t width, size_t height) {
+    const format_info *info = &(formats[format]);
+    uint8_t *out = dst;
+
+    /* Same layout, nothing to convert */
+    if (format == ul_convert_get_native_format()) {
+        for (size_t y = 0; y < height; ++y) {
+            memcpy(out, src, width * sizeof(lv_color_t));
+            out += dst_stride;
+            src += src_stride;
+        }
+        return;
+    }
+
+    convert_fn convert = convert_16_impl;
+    if (info->bytes_per_pixel == 4) {
+        convert = convert_32_impl;
+    } else if (info->bytes_per_pixel == 3) {
+        convert = convert_24_impl;
+    }
+
+    for (size_t y = 0; y < height; ++y) {
+        convert(out, src, width, info->is_bgr);
+        out += dst_stride;
+        src += src_stride;
+    }
+}
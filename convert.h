@@ -0,0 +1,104 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_CONVERT_H
+#define UL_CONVERT_H
+
+#include "lvgl/lvgl.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Scanout pixel formats, named like DRM formats: channels are listed from the most significant bit of a little
+ * endian pixel, X marks unused bits */
+typedef enum {
+    UL_CONVERT_FORMAT_UNKNOWN = 0,
+    UL_CONVERT_FORMAT_XRGB8888,
+    UL_CONVERT_FORMAT_XBGR8888,
+    UL_CONVERT_FORMAT_RGB888,
+    UL_CONVERT_FORMAT_BGR888,
+    UL_CONVERT_FORMAT_RGB565,
+    UL_CONVERT_FORMAT_BGR565,
+    UL_CONVERT_FORMAT_COUNT
+} ul_convert_format;
+
+/**
+ * Pick the fastest conversion implementations for the running CPU. Must be called before any other thread is started,
+ * calling it again is harmless.
+ */
+void ul_convert_init(void);
+
+/**
+ * Get the name of the conversion implementation in use, for logging.
+ *
+ * @return implementation name
+ */
+const char *ul_convert_get_implementation_name(void);
+
+/**
+ * Get the format that lv_color_t pixels are stored in.
+ *
+ * @return LVGL's pixel format or UL_CONVERT_FORMAT_UNKNOWN if it is none of the scanout formats
+ */
+ul_convert_format ul_convert_get_native_format(void);
+
+/**
+ * Identify a packed true colour format from the channel layout reported by a device.
+ *
+ * @param bits_per_pixel size of a pixel in bits
+ * @param red_offset bit offset of the red channel
+ * @param green_offset bit offset of the green channel
+ * @param blue_offset bit offset of the blue channel
+ * @return the format or UL_CONVERT_FORMAT_UNKNOWN if it is not supported
+ */
+ul_convert_format ul_convert_find_format(uint32_t bits_per_pixel, uint32_t red_offset, uint32_t green_offset,
+    uint32_t blue_offset);
+
+/**
+ * Get the size of a pixel.
+ *
+ * @param format pixel format
+ * @return size in bytes, 0 for UL_CONVERT_FORMAT_UNKNOWN
+ */
+size_t ul_convert_get_bytes_per_pixel(ul_convert_format format);
+
+/**
+ * Get the name of a pixel format, for logging.
+ *
+ * @param format pixel format
+ * @return format name
+ */
+const char *ul_convert_get_format_name(ul_convert_format format);
+
+/**
+ * Convert a rectangle of LVGL pixels into another format, e.g. while flushing them to the display.
+ *
+ * @param format format to convert to, must not be UL_CONVERT_FORMAT_UNKNOWN
+ * @param dst first pixel to write
+ * @param dst_stride distance between consecutive rows at dst in bytes
+ * @param src first pixel to read
+ * @param src_stride distance between consecutive rows at src in pixels
+ * @param width number of pixels per row
+ * @param height number of rows
+ */
+void ul_convert_area(ul_convert_format format, void *dst, size_t dst_stride, const lv_color_t *src, size_t src_stride,
+    size_t width, size_t height);
+
+#endif /* UL_CONVERT_H */
@@ -0,0 +1,93 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "cpu.h"
+
+#include <string.h>
+
+#if defined(__aarch64__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+
+/**
+ * Static variables
+ */
+
+static uint32_t features = 0;
+static bool are_features_detected = false;
+static char feature_names[32];
+
+
+/**
+ * Public functions
+ */
+
+void ul_cpu_detect_features(void) {
+    if (are_features_detected) {
+        return;
+    }
+
+    features = 0;
+
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+        features |= UL_CPU_FEATURE_SSE2;
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        features |= UL_CPU_FEATURE_SSSE3;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        features |= UL_CPU_FEATURE_AVX2;
+    }
+#elif defined(__aarch64__)
+    if (getauxval(AT_HWCAP) & HWCAP_ASIMD) {
+        features |= UL_CPU_FEATURE_NEON;
+    }
+#endif
+
+    feature_names[0] = '\0';
+    if (features & UL_CPU_FEATURE_SSE2) {
+        strcat(feature_names, " sse2");
+    }
+    if (features & UL_CPU_FEATURE_SSSE3) {
+        strcat(feature_names, " ssse3");
+    }
+    if (features & UL_CPU_FEATURE_AVX2) {
+        strcat(feature_names, " avx2");
+    }
+    if (features & UL_CPU_FEATURE_NEON) {
+        strcat(feature_names, " neon");
+    }
+
+    are_features_detected = true;
+}
+
+bool ul_cpu_has_feature(ul_cpu_feature feature) {
+    ul_cpu_detect_features();
+    return (features & feature) != 0;
+}
+
+const char *ul_cpu_get_feature_names(void) {
+    ul_cpu_detect_features();
+    return features == 0 ? "none" : feature_names + 1;
+}
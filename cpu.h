@@ -0,0 +1,57 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_CPU_H
+#define UL_CPU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * SIMD instruction set extensions that optimised code paths may use
+ */
+typedef enum {
+    UL_CPU_FEATURE_SSE2 = 1 << 0,
+    UL_CPU_FEATURE_SSSE3 = 1 << 1,
+    UL_CPU_FEATURE_AVX2 = 1 << 2,
+    UL_CPU_FEATURE_NEON = 1 << 3
+} ul_cpu_feature;
+
+/**
+ * Detect the features of the CPU we are running on. Must be called before any other thread is started.
+ */
+void ul_cpu_detect_features(void);
+
+/**
+ * Check whether the CPU supports an instruction set extension.
+ *
+ * @param feature feature to check
+ * @return true if the feature is available
+ */
+bool ul_cpu_has_feature(ul_cpu_feature feature);
+
+/**
+ * Get a human readable list of the detected features, for logging.
+ *
+ * @return space separated feature names or "none"
+ */
+const char *ul_cpu_get_feature_names(void);
+
+#endif /* UL_CPU_H */
@@ -0,0 +1,123 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "display.h"
+
+#include <string.h>
+
+
+/**
+ * Static variables
+ */
+
+static ul_display_damage_cb display_damage_cb = NULL;
+static bool is_move_enabled = false;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Check whether an area overlaps an area that is waiting to be redrawn. Moving it would leave stale pixels behind.
+ *
+ * @param disp display
+ * @param area area to check
+ * @return true if part of the area is invalidated
+ */
+static bool is_area_invalidated(const lv_disp_t *disp, const lv_area_t *area);
+
+
+/**
+ * Static functions
+ */
+
+static bool is_area_invalidated(const lv_disp_t *disp, const lv_area_t *area) {
+    for (uint16_t i = 0; i < disp->inv_p; ++i) {
+        if (!disp->inv_area_joined[i] && _lv_area_is_on(&(disp->inv_areas[i]), area)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+ * Public functions
+ */
+
+void ul_display_set_damage_cb(ul_display_damage_cb damage_cb) {
+    display_damage_cb = damage_cb;
+}
+
+void ul_display_set_move_enabled(bool is_enabled) {
+    is_move_enabled = is_enabled;
+}
+
+bool ul_display_move_area(lv_disp_t *disp, const lv_area_t *area, lv_coord_t distance) {
+    lv_disp_drv_t *disp_drv = disp->driver;
+    lv_disp_draw_buf_t *draw_buf = disp_drv->draw_buf;
+
+    /* The frame only persists if LVGL always renders into the same full-screen buffer */
+    if (!is_move_enabled || !disp_drv->direct_mode || draw_buf->buf2 || draw_buf->flushing
+        || disp_drv->rotated != LV_DISP_ROT_NONE) {
+        return false;
+    }
+
+    const lv_area_t screen = { .x1 = 0, .y1 = 0, .x2 = disp_drv->hor_res - 1, .y2 = disp_drv->ver_res - 1 };
+    const lv_coord_t height = lv_area_get_height(area);
+    if (!_lv_area_is_in(area, &screen, 0) || distance == 0 || LV_ABS(distance) >= height
+        || is_area_invalidated(disp, area)) {
+        return false;
+    }
+
+    lv_color_t *frame = draw_buf->buf1;
+    const lv_coord_t stride = disp_drv->hor_res;
+    const size_t row_size = (size_t)lv_area_get_width(area) * sizeof(lv_color_t);
+    const lv_coord_t count = height - LV_ABS(distance);
+
+    /* Go against the direction of the move so that no source row is overwritten before it was copied */
+    if (distance < 0) {
+        for (lv_coord_t i = 0; i < count; ++i) {
+            lv_coord_t y = area->y1 + i;
+            memcpy(&(frame[(size_t)y * stride + area->x1]), &(frame[(size_t)(y - distance) * stride + area->x1]),
+                row_size);
+        }
+    } else {
+        for (lv_coord_t i = count - 1; i >= 0; --i) {
+            lv_coord_t y = area->y1 + distance + i;
+            memcpy(&(frame[(size_t)y * stride + area->x1]), &(frame[(size_t)(y - distance) * stride + area->x1]),
+                row_size);
+        }
+    }
+
+    if (display_damage_cb) {
+        lv_area_t moved = *area;
+        if (distance < 0) {
+            moved.y2 += distance;
+        } else {
+            moved.y1 += distance;
+        }
+        display_damage_cb(&moved);
+    }
+
+    return true;
+}
@@ -0,0 +1,59 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef UL_DISPLAY_H
+#define UL_DISPLAY_H
+
+#include "lvgl/lvgl.h"
+
+#include <stdbool.h>
+
+/* Called after pixels of the frame were changed without LVGL rendering them, so that the backend can present them */
+typedef void (*ul_display_damage_cb)(const lv_area_t *area);
+
+/**
+ * Set the function to call after ul_display_move_area changed the frame.
+ *
+ * @param damage_cb callback or NULL if the backend shows the frame as it is
+ */
+void ul_display_set_damage_cb(ul_display_damage_cb damage_cb);
+
+/**
+ * Allow ul_display_move_area to move pixels of the frame. Moving reads the frame back, so backends should only enable
+ * it if the frame lives in cached memory, e.g. a shadow buffer, rather than in uncached video memory.
+ *
+ * @param is_enabled true to allow moves, false (default) to have the caller redraw instead
+ */
+void ul_display_set_move_enabled(bool is_enabled);
+
+/**
+ * Move the pixels of an area of the last rendered frame vertically, e.g. to scroll text without rendering it again.
+ * Rows that the area moves away from keep their old pixels and have to be redrawn by the caller. Only possible if
+ * the backend enabled moves and the frame persists between refreshes, i.e. in direct mode with a single draw buffer.
+ *
+ * @param disp display
+ * @param area area to move, in display coordinates
+ * @param distance number of pixels to move down by (negative for up)
+ * @return true if the pixels were moved, false if the area has to be redrawn instead
+ */
+bool ul_display_move_area(lv_disp_t *disp, const lv_area_t *area, lv_coord_t distance);
+
+#endif /* UL_DISPLAY_H */
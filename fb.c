@@ -0,0 +1,163 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "fb.h"
+
+#include "convert.h"
+#include "log.h"
+
+#include "lv_drv_conf.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <linux/fb.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+
+
+/**
+ * Static variables
+ */
+
+static uint32_t width = 0;
+static uint32_t height = 0;
+static uint32_t mm_width = 0;
+/* First pixel of the visible screen and distance between its rows in bytes */
+static uint8_t *screen = NULL;
+static size_t line_length = 0;
+/* Pixel format of video memory */
+static ul_convert_format format = UL_CONVERT_FORMAT_UNKNOWN;
+/* LVGL renders straight into video memory */
+static bool is_direct = false;
+
+
+/**
+ * Public functions
+ */
+
+bool ul_fb_init(void) {
+    int fd = open(FBDEV_PATH, O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        ul_log(UL_LOG_LEVEL_VERBOSE, "Could not open %s: %s", FBDEV_PATH, strerror(errno));
+        return false;
+    }
+
+    struct fb_var_screeninfo var_info;
+    struct fb_fix_screeninfo fix_info;
+    if (ioctl(fd, FBIOGET_FSCREENINFO, &fix_info) < 0 || ioctl(fd, FBIOGET_VSCREENINFO, &var_info) < 0) {
+        ul_log(UL_LOG_LEVEL_VERBOSE, "Could not query %s: %s", FBDEV_PATH, strerror(errno));
+        close(fd);
+        return false;
+    }
+
+    if (fix_info.type != FB_TYPE_PACKED_PIXELS || fix_info.visual != FB_VISUAL_TRUECOLOR) {
+        ul_log(UL_LOG_LEVEL_VERBOSE, "Framebuffer is not packed true colour");
+        close(fd);
+        return false;
+    }
+
+    const ul_convert_format fb_format = ul_convert_find_format(var_info.bits_per_pixel, var_info.red.offset,
+        var_info.green.offset, var_info.blue.offset);
+    if (fb_format == UL_CONVERT_FORMAT_UNKNOWN) {
+        ul_log(UL_LOG_LEVEL_VERBOSE, "Framebuffer has an unsupported %u bit pixel format", var_info.bits_per_pixel);
+        close(fd);
+        return false;
+    }
+
+    const size_t offset = (size_t)var_info.yoffset * fix_info.line_length
+        + (size_t)var_info.xoffset * ul_convert_get_bytes_per_pixel(fb_format);
+    const size_t screen_size = (size_t)var_info.yres * fix_info.line_length;
+    if (offset + screen_size > fix_info.smem_len) {
+        close(fd);
+        return false;
+    }
+
+    /* Make sure the console did not leave the display blanked */
+    ioctl(fd, FBIOBLANK, FB_BLANK_UNBLANK);
+
+    void *data = mmap(NULL, fix_info.smem_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        ul_log(UL_LOG_LEVEL_VERBOSE, "Could not map %s: %s", FBDEV_PATH, strerror(errno));
+        return false;
+    }
+
+    screen = (uint8_t *)data + offset;
+    line_length = fix_info.line_length;
+    format = fb_format;
+    width = var_info.xres;
+    height = var_info.yres;
+    mm_width = var_info.width;
+
+    /* Unpadded rows of LVGL's own format can be rendered into as they are */
+    is_direct = format == ul_convert_get_native_format() && line_length == width * sizeof(lv_color_t);
+
+    if (is_direct) {
+        ul_log(UL_LOG_LEVEL_VERBOSE, "Rendering directly into %s (%ux%u)", FBDEV_PATH, width, height);
+    } else {
+        ul_log(UL_LOG_LEVEL_VERBOSE, "Converting to %s while flushing to %s (%ux%u, %zu bytes per row)",
+            ul_convert_get_format_name(format), FBDEV_PATH, width, height, line_length);
+    }
+    return true;
+}
+
+void ul_fb_get_sizes(uint32_t *hor_res, uint32_t *ver_res, uint32_t *dpi) {
+    if (hor_res) {
+        *hor_res = width;
+    }
+    if (ver_res) {
+        *ver_res = height;
+    }
+    if (dpi) {
+        /* Some drivers report 0 or -1 for an unknown physical size */
+        *dpi = mm_width > 0 && mm_width != UINT32_MAX ? (width * 254 + mm_width * 5) / (mm_width * 10) : LV_DPI_DEF;
+    }
+}
+
+lv_color_t *ul_fb_get_buffer(void) {
+    return is_direct ? (lv_color_t *)screen : NULL;
+}
+
+void ul_fb_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p) {
+    /* In direct mode the pixels are already in video memory. Areas that were not redrawn still hold the previous
+     * frame because the buffer is never swapped, so partial redraws stay correct without any bookkeeping here. */
+    if (is_direct) {
+        lv_disp_flush_ready(disp_drv);
+        return;
+    }
+
+    /* The draw buffer holds just the area, clip it to the screen */
+    lv_area_t clipped;
+    const lv_area_t screen_area = { 0, 0, (lv_coord_t)width - 1, (lv_coord_t)height - 1 };
+    if (_lv_area_intersect(&clipped, area, &screen_area)) {
+        const size_t src_stride = (size_t)lv_area_get_width(area);
+        const lv_color_t *src = color_p + (size_t)(clipped.y1 - area->y1) * src_stride + (clipped.x1 - area->x1);
+        uint8_t *dst = screen + (size_t)clipped.y1 * line_length
+            + (size_t)clipped.x1 * ul_convert_get_bytes_per_pixel(format);
+        ul_convert_area(format, dst, line_length, src, src_stride, (size_t)lv_area_get_width(&clipped),
+            (size_t)lv_area_get_height(&clipped));
+    }
+
+    lv_disp_flush_ready(disp_drv);
+}
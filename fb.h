@@ -0,0 +1,65 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef UL_FB_H
+#define UL_FB_H
+
+#include "lvgl/lvgl.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Map the framebuffer device. If the visible screen is laid out exactly like an array of lv_color_t, i.e. the pixel
+ * format matches and rows are not padded, LVGL can render straight into video memory in direct mode, without copying
+ * through an intermediate draw buffer. Otherwise flushed areas are converted into the framebuffer's format.
+ *
+ * @return true on success, false if the device is missing or its pixel format is not supported (nothing is left
+ * behind in that case)
+ */
+bool ul_fb_init(void);
+
+/**
+ * Get the size of the framebuffer.
+ *
+ * @param hor_res pointer for writing the horizontal resolution
+ * @param ver_res pointer for writing the vertical resolution
+ * @param dpi pointer for writing the pixel density
+ */
+void ul_fb_get_sizes(uint32_t *hor_res, uint32_t *ver_res, uint32_t *dpi);
+
+/**
+ * Get the start of the visible screen in video memory, to be used as LVGL's only draw buffer.
+ *
+ * @return first pixel of the visible screen or NULL if its layout differs from LVGL's and flushing converts it
+ */
+lv_color_t *ul_fb_get_buffer(void);
+
+/**
+ * Flush callback for the framebuffer. In direct mode the display driver must draw into ul_fb_get_buffer.
+ *
+ * @param disp_drv display driver
+ * @param area area that was rendered
+ * @param color_p draw buffer
+ */
+void ul_fb_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p);
+
+#endif /* UL_FB_H */
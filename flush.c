@@ -0,0 +1,145 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "flush.h"
+
+#include "log.h"
+
+#include <pthread.h>
+
+
+/**
+ * Static variables
+ */
+
+static pthread_t flush_id;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+/* Signalled when a flush was queued or finished */
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+
+/* The driver's own flush callback */
+static void (*device_flush_cb)(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p) = NULL;
+
+/* Flush waiting to be picked up by the worker. LVGL never queues another one before the previous has finished. */
+static bool is_flush_queued = false;
+/* A flush is queued or in progress */
+static bool is_busy = false;
+static lv_disp_drv_t *queued_disp_drv = NULL;
+static lv_area_t queued_area;
+static lv_color_t *queued_color_p = NULL;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Run queued flushes until the program exits.
+ *
+ * @param arg unused
+ * @return never returns
+ */
+static void *flush_thread(void *arg);
+
+/**
+ * Flush callback that hands the rendered chunk to the worker and returns right away.
+ *
+ * @param disp_drv display driver
+ * @param area area that was rendered
+ * @param color_p rendered pixels
+ */
+static void queue_flush_cb(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p);
+
+/**
+ * Wait callback that sleeps until the worker finished instead of letting LVGL spin.
+ *
+ * @param disp_drv display driver
+ */
+static void wait_flush_cb(lv_disp_drv_t *disp_drv);
+
+
+/**
+ * Static functions
+ */
+
+static void *flush_thread(void *arg) {
+    LV_UNUSED(arg);
+
+    while (true) {
+        pthread_mutex_lock(&lock);
+        while (!is_flush_queued) {
+            pthread_cond_wait(&cond, &lock);
+        }
+        /* LVGL's area lives on its stack, so work on a copy */
+        lv_disp_drv_t *disp_drv = queued_disp_drv;
+        lv_area_t area = queued_area;
+        lv_color_t *color_p = queued_color_p;
+        is_flush_queued = false;
+        pthread_mutex_unlock(&lock);
+
+        device_flush_cb(disp_drv, &area, color_p);
+
+        pthread_mutex_lock(&lock);
+        /* The device callback already marked the buffer as free, so LVGL may have queued the next flush meanwhile */
+        is_busy = is_flush_queued;
+        pthread_cond_broadcast(&cond);
+        pthread_mutex_unlock(&lock);
+    }
+
+    return NULL;
+}
+
+static void queue_flush_cb(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p) {
+    pthread_mutex_lock(&lock);
+    queued_disp_drv = disp_drv;
+    queued_area = *area;
+    queued_color_p = color_p;
+    is_flush_queued = true;
+    is_busy = true;
+    pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&lock);
+}
+
+static void wait_flush_cb(lv_disp_drv_t *disp_drv) {
+    pthread_mutex_lock(&lock);
+    while (is_busy && disp_drv->draw_buf->flushing) {
+        pthread_cond_wait(&cond, &lock);
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+
+/**
+ * Public functions
+ */
+
+bool ul_flush_start(lv_disp_drv_t *disp_drv) {
+    device_flush_cb = disp_drv->flush_cb;
+
+    if (pthread_create(&flush_id, NULL, flush_thread, NULL) != 0) {
+        ul_log(UL_LOG_LEVEL_WARNING, "Could not start flush thread");
+        return false;
+    }
+
+    disp_drv->flush_cb = queue_flush_cb;
+    disp_drv->wait_cb = wait_flush_cb;
+    return true;
+}
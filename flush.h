@@ -0,0 +1,40 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef UL_FLUSH_H
+#define UL_FLUSH_H
+
+#include "lvgl/lvgl.h"
+
+#include <stdbool.h>
+
+/**
+ * Move a display driver's flushes onto a worker thread so that LVGL can render the next chunk into its second draw
+ * buffer while the previous one is copied to the device. The driver's flush callback is called on the worker and
+ * must only touch the area and pixels it is given before calling lv_disp_flush_ready. Replaces the driver's flush
+ * and wait callbacks, so it must be called after flush_cb has been set up and before the driver is registered.
+ *
+ * @param disp_drv display driver
+ * @return true on success, false if the worker could not be started (the driver is left unchanged in that case)
+ */
+bool ul_flush_start(lv_disp_drv_t *disp_drv);
+
+#endif /* UL_FLUSH_H */
@@ -0,0 +1,173 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#define _GNU_SOURCE /* memfd_create */
+
+#include "headless.h"
+
+#include "log.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+
+
+/**
+ * Static variables
+ */
+
+static uint32_t width = 0;
+static uint32_t height = 0;
+static lv_color_t *frame_buffer = NULL;
+static size_t frame_size = 0;
+static int dump_fd = -1;
+static uint64_t frame_count = 0;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Map a zeroed frame buffer, backed by a memfd where available and by anonymous memory otherwise.
+ *
+ * @param size size in bytes
+ * @return the mapping or NULL on failure
+ */
+static void *map_frame_buffer(size_t size);
+
+/**
+ * Append the current frame to the dump file.
+ */
+static void dump_frame(void);
+
+
+/**
+ * Static functions
+ */
+
+static void *map_frame_buffer(size_t size) {
+    int fd = memfd_create("furios-terminal-headless", MFD_CLOEXEC);
+    if (fd >= 0 && ftruncate(fd, size) == 0) {
+        void *mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        return mapping == MAP_FAILED ? NULL : mapping;
+    }
+
+    if (fd >= 0) {
+        close(fd);
+    }
+    ul_log(UL_LOG_LEVEL_VERBOSE, "Could not create memfd (%s), using anonymous memory", strerror(errno));
+
+    void *mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return mapping == MAP_FAILED ? NULL : mapping;
+}
+
+static void dump_frame(void) {
+    const uint8_t *data = (const uint8_t *)frame_buffer;
+    size_t remaining = frame_size;
+
+    while (remaining > 0) {
+        ssize_t written = write(dump_fd, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ul_log(UL_LOG_LEVEL_WARNING, "Could not dump frame, disabling frame dumps: %s", strerror(errno));
+            close(dump_fd);
+            dump_fd = -1;
+            return;
+        }
+        data += written;
+        remaining -= written;
+    }
+}
+
+
+/**
+ * Public functions
+ */
+
+bool ul_headless_init(uint32_t hor_res, uint32_t ver_res, const char *dump_path) {
+    width = hor_res > 0 ? hor_res : UL_HEADLESS_DEFAULT_HOR_RES;
+    height = ver_res > 0 ? ver_res : UL_HEADLESS_DEFAULT_VER_RES;
+    frame_size = (size_t)width * height * sizeof(lv_color_t);
+
+    frame_buffer = map_frame_buffer(frame_size);
+    if (!frame_buffer) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not allocate headless frame buffer of %ux%u", width, height);
+        return false;
+    }
+
+    if (dump_path) {
+        dump_fd = open(dump_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (dump_fd < 0) {
+            ul_log(UL_LOG_LEVEL_WARNING, "Could not open frame dump file %s: %s", dump_path, strerror(errno));
+        }
+    }
+
+    ul_log(UL_LOG_LEVEL_VERBOSE, "Headless display of %ux%u, %u bits per pixel", width, height, LV_COLOR_DEPTH);
+    return true;
+}
+
+void ul_headless_get_sizes(uint32_t *hor_res, uint32_t *ver_res, uint32_t *dpi) {
+    if (hor_res) {
+        *hor_res = width;
+    }
+    if (ver_res) {
+        *ver_res = height;
+    }
+    if (dpi) {
+        *dpi = UL_HEADLESS_DEFAULT_DPI;
+    }
+}
+
+void ul_headless_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p) {
+    /* The area may stick out of the display when an offset is applied */
+    int32_t x1 = LV_MAX(area->x1, 0);
+    int32_t y1 = LV_MAX(area->y1, 0);
+    int32_t x2 = LV_MIN(area->x2, (int32_t)width - 1);
+    int32_t y2 = LV_MIN(area->y2, (int32_t)height - 1);
+    const int32_t area_width = lv_area_get_width(area);
+
+    if (x1 <= x2 && y1 <= y2) {
+        const size_t row_size = (size_t)(x2 - x1 + 1) * sizeof(lv_color_t);
+        for (int32_t y = y1; y <= y2; ++y) {
+            const lv_color_t *src = color_p + (size_t)(y - area->y1) * area_width + (x1 - area->x1);
+            memcpy(&(frame_buffer[(size_t)y * width + x1]), src, row_size);
+        }
+    }
+
+    if (lv_disp_flush_is_last(disp_drv)) {
+        frame_count++;
+        if (dump_fd >= 0) {
+            dump_frame();
+        }
+    }
+
+    lv_disp_flush_ready(disp_drv);
+}
+
+uint64_t ul_headless_get_frame_count(void) {
+    return frame_count;
+}
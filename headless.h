@@ -0,0 +1,69 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_HEADLESS_H
+#define UL_HEADLESS_H
+
+#include "lvgl/lvgl.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Display size used when no geometry is given on the command line */
+#define UL_HEADLESS_DEFAULT_HOR_RES 720
+#define UL_HEADLESS_DEFAULT_VER_RES 1440
+#define UL_HEADLESS_DEFAULT_DPI 300
+
+/**
+ * Set up an in-memory display that needs no device nodes, for benchmarking and CI.
+ *
+ * @param hor_res horizontal resolution, 0 for the default
+ * @param ver_res vertical resolution, 0 for the default
+ * @param dump_path file to append every completed frame to as raw lv_color_t pixels, NULL to not dump frames
+ * @return true on success, false if the frame buffer could not be set up
+ */
+bool ul_headless_init(uint32_t hor_res, uint32_t ver_res, const char *dump_path);
+
+/**
+ * Get the size of the in-memory display.
+ *
+ * @param hor_res pointer for writing the horizontal resolution
+ * @param ver_res pointer for writing the vertical resolution
+ * @param dpi pointer for writing the pixel density
+ */
+void ul_headless_get_sizes(uint32_t *hor_res, uint32_t *ver_res, uint32_t *dpi);
+
+/**
+ * Flush callback that copies rendered areas into the in-memory frame buffer.
+ *
+ * @param disp_drv display driver
+ * @param area area that was rendered
+ * @param color_p rendered pixels
+ */
+void ul_headless_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p);
+
+/**
+ * Get the number of frames that were completed so far.
+ *
+ * @return frame count
+ */
+uint64_t ul_headless_get_frame_count(void);
+
+#endif /* UL_HEADLESS_H */
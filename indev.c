@@ -22,9 +22,11 @@
 
 #include "cursor.h"
 #include "log.h"
+#include "loop.h"
 
 #include "lv_drivers/indev/libinput_drv.h"
 
+#include <libinput.h>
 #include <limits.h>
 
 
@@ -59,6 +61,13 @@ static lv_indev_t *touchscreen_indevs[MAX_TOUCHSCREEN_DEVS];
 static lv_indev_drv_t touchscreen_indev_drvs[MAX_TOUCHSCREEN_DEVS];
 static libinput_drv_state_t touchscreen_drv_states[MAX_TOUCHSCREEN_DEVS];
 
+static lv_disp_rot_t touchscreen_rotation = LV_DISP_ROT_NONE;
+
+static ul_indev_cursor_load_cb cursor_load_cb = NULL;
+static ul_indev_cursor_move_cb cursor_move_cb = NULL;
+/* Last position of the hardware cursor */
+static lv_point_t cursor_point = { .x = 0, .y = 0 };
+
 
 /**
  * Static prototypes
@@ -94,6 +103,38 @@ static void log_connection(libinput_capability capability, char *dev);
  */
 static void libinput_read_cb(lv_indev_drv_t *indev_drv, lv_indev_data_t *data);
 
+/**
+ * Perform an input read on a touchscreen and map the touch point onto the rotated display.
+ *
+ * @param indev_drv input device driver
+ * @param data input device data to write into
+ */
+static void touchscreen_read_cb(lv_indev_drv_t *indev_drv, lv_indev_data_t *data);
+
+/**
+ * Perform an input read on a pointer device and move the hardware cursor along.
+ *
+ * @param indev_drv input device driver
+ * @param data input device data to write into
+ */
+static void pointer_read_cb(lv_indev_drv_t *indev_drv, lv_indev_data_t *data);
+
+/**
+ * Get the file descriptor that becomes readable when a device has pending events.
+ *
+ * @param indev_drv input device driver
+ * @return file descriptor or -1 if the device could not be opened
+ */
+static int get_libinput_fd(lv_indev_drv_t *indev_drv);
+
+/**
+ * Read a device right away after its file descriptor became readable.
+ *
+ * @param fd libinput file descriptor
+ * @param user_data input device driver
+ */
+static void libinput_readable_cb(int fd, void *user_data);
+
 
 /**
  * Static functions
@@ -115,7 +156,7 @@ static void auto_connect(libinput_capability capability, int max_num_devs, int *
         libinput_init_state(&(drv_states[i]), devs[i]);
         lv_indev_drv_init(&(indev_drvs[i]));
 
-        indev_drvs[i].read_cb = libinput_read_cb;
+        indev_drvs[i].read_cb = capability == LIBINPUT_CAPABILITY_TOUCH ? touchscreen_read_cb : libinput_read_cb;
         indev_drvs[i].user_data = &(drv_states[i]);
 
         if (capability == LIBINPUT_CAPABILITY_KEYBOARD) {
@@ -126,6 +167,14 @@ static void auto_connect(libinput_capability capability, int max_num_devs, int *
         }
 
         indevs[i] = lv_indev_drv_register(&(indev_drvs[i]));
+
+        /* Only read the device when it has events instead of polling it. While it is pressed it is read once per
+         * display refresh, which coalesces motion events and keeps long presses and key repeat working. */
+        int fd = get_libinput_fd(&(indev_drvs[i]));
+        if (fd >= 0 && ul_loop_add_fd(fd, libinput_readable_cb, &(indev_drvs[i]))) {
+            lv_timer_set_period(indev_drvs[i].read_timer, LV_DISP_DEF_REFR_PERIOD);
+            lv_timer_pause(indev_drvs[i].read_timer);
+        }
     }
 }
 
@@ -147,6 +196,68 @@ static void log_connection(libinput_capability capability, char *dev) {
 
 static void libinput_read_cb(lv_indev_drv_t *indev_drv, lv_indev_data_t *data) {
     libinput_read_state(indev_drv->user_data, indev_drv, data);
+
+    /* Go back to sleeping on the file descriptor once the device has been released */
+    int fd = get_libinput_fd(indev_drv);
+    if (fd >= 0 && data->state == LV_INDEV_STATE_RELEASED && !data->continue_reading) {
+        lv_timer_pause(indev_drv->read_timer);
+        ul_loop_set_fd_enabled(fd, true);
+    }
+}
+
+static void touchscreen_read_cb(lv_indev_drv_t *indev_drv, lv_indev_data_t *data) {
+    libinput_read_cb(indev_drv, data);
+
+    if (touchscreen_rotation == LV_DISP_ROT_NONE) {
+        return;
+    }
+
+    /* The driver scales the panel's axes onto the display's (rotated) resolution. Undo that for the axes that
+     * swap places and turn the point along with the image. */
+    const int32_t width = lv_disp_get_hor_res(indev_drv->disp);
+    const int32_t height = lv_disp_get_ver_res(indev_drv->disp);
+    const int32_t x = data->point.x;
+    const int32_t y = data->point.y;
+
+    switch (touchscreen_rotation) {
+        case LV_DISP_ROT_90:
+            data->point.x = (lv_coord_t)(width - 1 - y * width / height);
+            data->point.y = (lv_coord_t)(x * height / width);
+            break;
+        case LV_DISP_ROT_180:
+            data->point.x = (lv_coord_t)(width - 1 - x);
+            data->point.y = (lv_coord_t)(height - 1 - y);
+            break;
+        case LV_DISP_ROT_270:
+            data->point.x = (lv_coord_t)(y * width / height);
+            data->point.y = (lv_coord_t)(height - 1 - x * height / width);
+            break;
+        case LV_DISP_ROT_NONE:
+            break;
+    }
+}
+
+static void pointer_read_cb(lv_indev_drv_t *indev_drv, lv_indev_data_t *data) {
+    libinput_read_cb(indev_drv, data);
+
+    if (data->point.x != cursor_point.x || data->point.y != cursor_point.y) {
+        cursor_point = data->point;
+        cursor_move_cb(cursor_point.x, cursor_point.y);
+    }
+}
+
+static int get_libinput_fd(lv_indev_drv_t *indev_drv) {
+    libinput_drv_state_t *state = indev_drv->user_data;
+    return state->libinput_context ? libinput_get_fd(state->libinput_context) : -1;
+}
+
+static void libinput_readable_cb(int fd, void *user_data) {
+    lv_indev_drv_t *indev_drv = user_data;
+
+    /* The read timer drains the events, stop watching until the device is released again */
+    ul_loop_set_fd_enabled(fd, false);
+    lv_timer_resume(indev_drv->read_timer);
+    lv_timer_ready(indev_drv->read_timer);
 }
 
 
@@ -186,13 +297,32 @@ void ul_indev_set_up_textarea_for_keyboard_input(lv_obj_t *textarea) {
     }
 }
 
+void ul_indev_set_cursor_plane(ul_indev_cursor_load_cb load_cb, ul_indev_cursor_move_cb move_cb) {
+    cursor_load_cb = load_cb;
+    cursor_move_cb = move_cb;
+}
+
 void ul_indev_set_up_mouse_cursor() {
     if (num_pointer_devs == 0) {
         return;
     }
+
+    /* A hardware cursor is only moved, the frame below it is never touched */
+    if (cursor_load_cb && cursor_load_cb(&ul_cursor_img_dsc)) {
+        ul_log(UL_LOG_LEVEL_VERBOSE, "Showing the mouse cursor on a hardware plane");
+        for (int i = 0; i < num_pointer_devs; ++i) {
+            pointer_indev_drvs[i].read_cb = pointer_read_cb;
+        }
+        return;
+    }
+
     lv_obj_t *cursor_obj = lv_img_create(lv_scr_act());
     lv_img_set_src(cursor_obj, &ul_cursor_img_dsc);
     for (int i = 0; i < num_pointer_devs; ++i) {
         lv_indev_set_cursor(pointer_indevs[i], cursor_obj);
     }
 }
+
+void ul_indev_set_rotation(lv_disp_rot_t rotation) {
+    touchscreen_rotation = rotation;
+}
@@ -25,6 +25,12 @@
 
 #include <stdbool.h>
 
+/* Upload a cursor image to a hardware cursor plane. Returns false if the image cannot be shown that way. */
+typedef bool (*ul_indev_cursor_load_cb)(const lv_img_dsc_t *img);
+
+/* Move the hardware cursor's hot spot to a screen position */
+typedef void (*ul_indev_cursor_move_cb)(lv_coord_t x, lv_coord_t y);
+
 /**
  * Auto-connect currently available keyboard, pointer and touchscreen input devices.
  *
@@ -48,9 +54,26 @@ bool ul_indev_is_keyboard_connected();
  */
 void ul_indev_set_up_textarea_for_keyboard_input(lv_obj_t *textarea);
 
+/**
+ * Set the hardware cursor plane that the mouse cursor is shown on. Without one LVGL draws the cursor, which redraws
+ * the area below it on every movement. Must be called before ul_indev_set_up_mouse_cursor.
+ *
+ * @param load_cb function to upload the cursor image
+ * @param move_cb function to move the cursor
+ */
+void ul_indev_set_cursor_plane(ul_indev_cursor_load_cb load_cb, ul_indev_cursor_move_cb move_cb);
+
 /**
  * Set up the mouse cursor image for currently connected pointer devices.
  */
 void ul_indev_set_up_mouse_cursor();
 
+/**
+ * Set the counter-clockwise rotation of the image on the panel so that touchscreen input follows it. Touchscreens
+ * report positions on the physical panel while pointer devices move in the rotated coordinate space already.
+ *
+ * @param rotation display rotation
+ */
+void ul_indev_set_rotation(lv_disp_rot_t rotation);
+
 #endif /* UL_INDEV_H */
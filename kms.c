@@ -0,0 +1,719 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "kms.h"
+
+#include "log.h"
+#include "loop.h"
+
+#include "lv_drv_conf.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+
+#include <drm_fourcc.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+
+
+/**
+ * Defines
+ */
+
+/* Changed areas tracked per buffer before they are merged into their bounding box */
+#define MAX_DAMAGE_AREAS 16
+
+#if LV_COLOR_DEPTH == 32
+#define FB_DEPTH 24
+#define FB_FORMAT DRM_FORMAT_XRGB8888
+#elif LV_COLOR_DEPTH == 16
+#define FB_DEPTH 16
+#define FB_FORMAT DRM_FORMAT_RGB565
+#else
+#error "The DRM backend needs LV_COLOR_DEPTH 16 or 32"
+#endif
+
+/* A dumb buffer that can be scanned out */
+typedef struct {
+    uint32_t handle;
+    uint32_t fb_id;
+    uint32_t pitch;
+    uint64_t size;
+    uint8_t *map;
+    /* Areas that changed on screen since the buffer was last brought up to date */
+    lv_area_t damage[MAX_DAMAGE_AREAS];
+    int num_damage;
+} kms_buffer;
+
+/* Progress of taking the overlay plane down once the frame below shows what it covered */
+typedef enum {
+    OVERLAY_HIDE_NONE = 0,
+    /* Waiting for the next frame to be rendered */
+    OVERLAY_HIDE_REQUESTED,
+    /* The frame was rendered and waits to be flipped to */
+    OVERLAY_HIDE_RENDERED,
+    /* The flip to the frame is pending */
+    OVERLAY_HIDE_FLIPPING
+} overlay_hide_state;
+
+
+/**
+ * Static variables
+ */
+
+static int drm_fd = -1;
+static uint32_t connector_id = 0;
+static uint32_t crtc_id = 0;
+static int crtc_index = -1;
+static drmModeModeInfo mode;
+static uint32_t mm_width = 0;
+
+static kms_buffer buffers[UL_KMS_MAX_BUFFERS];
+static int num_buffers = 0;
+/* Buffer being scanned out */
+static int front = 0;
+/* Buffer that will be scanned out once the pending flip completes */
+static int flip_target = -1;
+/* Buffer that already holds a newer frame and is flipped to next (triple buffering only) */
+static int queued = -1;
+/* A frame finished while a flip was pending and still has to be presented */
+static bool is_frame_pending = false;
+
+/* LVGL's full-screen draw buffer, the source of all copies */
+static const lv_color_t *shadow = NULL;
+static lv_coord_t shadow_width = 0;
+static lv_coord_t shadow_height = 0;
+
+/* Overlay plane for pictures shown above the frame, 0 if there is none */
+static uint32_t overlay_plane_id = 0;
+static kms_buffer overlay_buffer;
+static lv_coord_t overlay_width = 0;
+static lv_coord_t overlay_height = 0;
+static bool is_overlay_enabled = false;
+static overlay_hide_state overlay_hide = OVERLAY_HIDE_NONE;
+
+/* ARGB8888 image of the hardware cursor, no handle if the cursor is drawn by LVGL */
+static kms_buffer cursor_buffer;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Pick the first connected connector, its preferred mode and a CRTC that can drive it.
+ *
+ * @return true on success
+ */
+static bool find_output(void);
+
+/**
+ * Find an unused overlay plane that can show dumb buffers on the CRTC.
+ *
+ * @return true if a plane was found
+ */
+static bool find_overlay_plane(void);
+
+/**
+ * Allocate and map a dumb buffer that can be scanned out in LVGL's colour format.
+ *
+ * @param buffer buffer to set up
+ * @param width width in pixels
+ * @param height height in pixels
+ * @return true on success
+ */
+static bool create_buffer(kms_buffer *buffer, uint32_t width, uint32_t height);
+
+/**
+ * Allocate and map a dumb buffer without a framebuffer for it.
+ *
+ * @param buffer buffer to set up
+ * @param width width in pixels
+ * @param height height in pixels
+ * @param bpp bits per pixel
+ * @return true on success
+ */
+static bool create_dumb_buffer(kms_buffer *buffer, uint32_t width, uint32_t height, uint32_t bpp);
+
+/**
+ * Release a dumb buffer.
+ *
+ * @param buffer buffer to release
+ */
+static void destroy_buffer(kms_buffer *buffer);
+
+/**
+ * Record that an area of the screen changed and has to be copied into a buffer before it is shown next.
+ *
+ * @param buffer buffer that is now out of date
+ * @param area changed area
+ */
+static void add_damage(kms_buffer *buffer, const lv_area_t *area);
+
+/**
+ * Copy all changed areas from the draw buffer into a scanout buffer.
+ *
+ * @param buffer buffer to bring up to date
+ */
+static void copy_damage(kms_buffer *buffer);
+
+/**
+ * Find a buffer that is neither scanned out nor about to be.
+ *
+ * @return buffer index
+ */
+static int get_free_buffer(void);
+
+/**
+ * Schedule a flip to a buffer at the next vertical blank.
+ *
+ * @param index buffer index
+ */
+static void flip_to(int index);
+
+/**
+ * Present the latest frame, or queue it if a flip is still pending.
+ */
+static void present_frame(void);
+
+/**
+ * Take the overlay plane down right away.
+ */
+static void disable_overlay(void);
+
+/**
+ * Handle a completed page flip.
+ *
+ * @param fd DRM file descriptor
+ * @param sequence vblank sequence number
+ * @param tv_sec timestamp seconds
+ * @param tv_usec timestamp microseconds
+ * @param user_data unused
+ */
+static void page_flip_handler(int fd, unsigned int sequence, unsigned int tv_sec, unsigned int tv_usec,
+    void *user_data);
+
+/**
+ * Dispatch pending DRM events after the main loop found the device readable.
+ *
+ * @param fd DRM file descriptor
+ * @param user_data unused
+ */
+static void drm_readable_cb(int fd, void *user_data);
+
+
+/**
+ * Static functions
+ */
+
+static bool find_output(void) {
+    drmModeRes *resources = drmModeGetResources(drm_fd);
+    if (!resources) {
+        ul_log(UL_LOG_LEVEL_WARNING, "Could not get DRM resources: %s", strerror(errno));
+        return false;
+    }
+
+    drmModeConnector *connector = NULL;
+    for (int i = 0; i < resources->count_connectors && !connector; ++i) {
+        connector = drmModeGetConnector(drm_fd, resources->connectors[i]);
+        if (connector && (connector->connection != DRM_MODE_CONNECTED || connector->count_modes == 0)) {
+            drmModeFreeConnector(connector);
+            connector = NULL;
+        }
+    }
+    if (!connector) {
+        ul_log(UL_LOG_LEVEL_WARNING, "No connected DRM connector found");
+        drmModeFreeResources(resources);
+        return false;
+    }
+
+    connector_id = connector->connector_id;
+    mm_width = connector->mmWidth;
+    mode = connector->modes[0];
+    for (int i = 0; i < connector->count_modes; ++i) {
+        if (connector->modes[i].type & DRM_MODE_TYPE_PREFERRED) {
+            mode = connector->modes[i];
+            break;
+        }
+    }
+
+    /* Prefer the CRTC that is already driving the connector */
+    crtc_id = 0;
+    drmModeEncoder *encoder = connector->encoder_id ? drmModeGetEncoder(drm_fd, connector->encoder_id) : NULL;
+    if (encoder) {
+        crtc_id = encoder->crtc_id;
+        drmModeFreeEncoder(encoder);
+    }
+    for (int i = 0; i < connector->count_encoders && !crtc_id; ++i) {
+        encoder = drmModeGetEncoder(drm_fd, connector->encoders[i]);
+        if (!encoder) {
+            continue;
+        }
+        for (int j = 0; j < resources->count_crtcs; ++j) {
+            if (encoder->possible_crtcs & (1u << j)) {
+                crtc_id = resources->crtcs[j];
+                break;
+            }
+        }
+        drmModeFreeEncoder(encoder);
+    }
+
+    /* Planes name the CRTCs they work with by index */
+    crtc_index = -1;
+    for (int i = 0; i < resources->count_crtcs && crtc_id; ++i) {
+        if (resources->crtcs[i] == crtc_id) {
+            crtc_index = i;
+            break;
+        }
+    }
+
+    drmModeFreeConnector(connector);
+    drmModeFreeResources(resources);
+
+    if (!crtc_id) {
+        ul_log(UL_LOG_LEVEL_WARNING, "No CRTC found for DRM connector %u", connector_id);
+        return false;
+    }
+    return true;
+}
+
+static bool find_overlay_plane(void) {
+    overlay_plane_id = 0;
+    if (crtc_index < 0 || crtc_index >= 32) {
+        return false;
+    }
+
+    /* Without the universal planes client capability only overlay planes are listed */
+    drmModePlaneRes *plane_resources = drmModeGetPlaneResources(drm_fd);
+    if (!plane_resources) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < plane_resources->count_planes && !overlay_plane_id; ++i) {
+        drmModePlane *plane = drmModeGetPlane(drm_fd, plane_resources->planes[i]);
+        if (!plane) {
+            continue;
+        }
+        if ((plane->possible_crtcs & (1u << crtc_index)) && !plane->crtc_id) {
+            for (uint32_t j = 0; j < plane->count_formats; ++j) {
+                if (plane->formats[j] == FB_FORMAT) {
+                    overlay_plane_id = plane->plane_id;
+                    break;
+                }
+            }
+        }
+        drmModeFreePlane(plane);
+    }
+
+    drmModeFreePlaneResources(plane_resources);
+    return overlay_plane_id != 0;
+}
+
+static bool create_buffer(kms_buffer *buffer, uint32_t width, uint32_t height) {
+    if (!create_dumb_buffer(buffer, width, height, LV_COLOR_DEPTH)) {
+        return false;
+    }
+
+    if (drmModeAddFB(drm_fd, width, height, FB_DEPTH, LV_COLOR_DEPTH, buffer->pitch, buffer->handle,
+            &(buffer->fb_id)) < 0) {
+        ul_log(UL_LOG_LEVEL_WARNING, "Could not add DRM framebuffer: %s", strerror(errno));
+        destroy_buffer(buffer);
+        return false;
+    }
+
+    return true;
+}
+
+static bool create_dumb_buffer(kms_buffer *buffer, uint32_t width, uint32_t height, uint32_t bpp) {
+    memset(buffer, 0, sizeof(*buffer));
+
+    struct drm_mode_create_dumb create = { .width = width, .height = height, .bpp = bpp };
+    if (drmIoctl(drm_fd, DRM_IOCTL_MODE_CREATE_DUMB, &create) < 0) {
+        ul_log(UL_LOG_LEVEL_WARNING, "Could not create DRM dumb buffer: %s", strerror(errno));
+        return false;
+    }
+    buffer->handle = create.handle;
+    buffer->pitch = create.pitch;
+    buffer->size = create.size;
+
+    struct drm_mode_map_dumb map = { .handle = buffer->handle };
+    if (drmIoctl(drm_fd, DRM_IOCTL_MODE_MAP_DUMB, &map) < 0) {
+        ul_log(UL_LOG_LEVEL_WARNING, "Could not map DRM dumb buffer: %s", strerror(errno));
+        destroy_buffer(buffer);
+        return false;
+    }
+    void *data = mmap(NULL, buffer->size, PROT_READ | PROT_WRITE, MAP_SHARED, drm_fd, map.offset);
+    if (data == MAP_FAILED) {
+        ul_log(UL_LOG_LEVEL_WARNING, "Could not map DRM dumb buffer: %s", strerror(errno));
+        destroy_buffer(buffer);
+        return false;
+    }
+    buffer->map = data;
+    memset(buffer->map, 0, buffer->size);
+
+    return true;
+}
+
+static void destroy_buffer(kms_buffer *buffer) {
+    if (buffer->map) {
+        munmap(buffer->map, buffer->size);
+    }
+    if (buffer->fb_id) {
+        drmModeRmFB(drm_fd, buffer->fb_id);
+    }
+    if (buffer->handle) {
+        struct drm_mode_destroy_dumb destroy = { .handle = buffer->handle };
+        drmIoctl(drm_fd, DRM_IOCTL_MODE_DESTROY_DUMB, &destroy);
+    }
+    memset(buffer, 0, sizeof(*buffer));
+}
+
+static void add_damage(kms_buffer *buffer, const lv_area_t *area) {
+    if (buffer->num_damage < MAX_DAMAGE_AREAS) {
+        buffer->damage[buffer->num_damage++] = *area;
+        return;
+    }
+
+    /* Too many separate areas, copy their bounding box instead */
+    lv_area_t *bounds = &(buffer->damage[0]);
+    for (int i = 1; i < buffer->num_damage; ++i) {
+        _lv_area_join(bounds, bounds, &(buffer->damage[i]));
+    }
+    _lv_area_join(bounds, bounds, area);
+    buffer->num_damage = 1;
+}
+
+static void copy_damage(kms_buffer *buffer) {
+    const lv_area_t screen = {
+        .x1 = 0,
+        .y1 = 0,
+        .x2 = LV_MIN(shadow_width, (lv_coord_t)mode.hdisplay) - 1,
+        .y2 = LV_MIN(shadow_height, (lv_coord_t)mode.vdisplay) - 1
+    };
+
+    for (int i = 0; i < buffer->num_damage; ++i) {
+        lv_area_t area;
+        if (!shadow || !_lv_area_intersect(&area, &(buffer->damage[i]), &screen)) {
+            continue;
+        }
+
+        const size_t row_size = (size_t)lv_area_get_width(&area) * sizeof(lv_color_t);
+        for (lv_coord_t y = area.y1; y <= area.y2; ++y) {
+            memcpy(buffer->map + (size_t)y * buffer->pitch + (size_t)area.x1 * sizeof(lv_color_t),
+                &(shadow[(size_t)y * shadow_width + area.x1]), row_size);
+        }
+    }
+
+    buffer->num_damage = 0;
+}
+
+static int get_free_buffer(void) {
+    for (int i = 0; i < num_buffers; ++i) {
+        if (i != front && i != flip_target) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void flip_to(int index) {
+    if (drmModePageFlip(drm_fd, crtc_id, buffers[index].fb_id, DRM_MODE_PAGE_FLIP_EVENT, NULL) == 0) {
+        flip_target = index;
+        if (overlay_hide == OVERLAY_HIDE_RENDERED) {
+            overlay_hide = OVERLAY_HIDE_FLIPPING;
+        }
+        return;
+    }
+
+    /* Without flip support fall back to switching immediately, which may tear */
+    ul_log(UL_LOG_LEVEL_VERBOSE, "DRM page flip failed (%s), setting the CRTC directly", strerror(errno));
+    drmModeSetCrtc(drm_fd, crtc_id, buffers[index].fb_id, 0, 0, &connector_id, 1, &mode);
+    front = index;
+    if (overlay_hide == OVERLAY_HIDE_RENDERED) {
+        disable_overlay();
+    }
+}
+
+static void present_frame(void) {
+    if (flip_target < 0) {
+        int index = queued >= 0 ? queued : get_free_buffer();
+        queued = -1;
+        copy_damage(&(buffers[index]));
+        flip_to(index);
+        return;
+    }
+
+    if (num_buffers > 2) {
+        /* Get the spare buffer ready now so that it can be flipped to as soon as the pending flip is done */
+        queued = get_free_buffer();
+        copy_damage(&(buffers[queued]));
+    }
+    is_frame_pending = true;
+}
+
+static void disable_overlay(void) {
+    if (is_overlay_enabled) {
+        drmModeSetPlane(drm_fd, overlay_plane_id, crtc_id, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+        is_overlay_enabled = false;
+    }
+    overlay_hide = OVERLAY_HIDE_NONE;
+}
+
+static void page_flip_handler(int fd, unsigned int sequence, unsigned int tv_sec, unsigned int tv_usec,
+    void *user_data) {
+    LV_UNUSED(fd);
+    LV_UNUSED(sequence);
+    LV_UNUSED(tv_sec);
+    LV_UNUSED(tv_usec);
+    LV_UNUSED(user_data);
+
+    front = flip_target;
+    flip_target = -1;
+
+    /* The frame that was rendered without the overlay's content being on it is on screen now */
+    if (overlay_hide == OVERLAY_HIDE_FLIPPING) {
+        disable_overlay();
+    }
+
+    if (is_frame_pending) {
+        is_frame_pending = false;
+        present_frame();
+    }
+}
+
+static void drm_readable_cb(int fd, void *user_data) {
+    LV_UNUSED(user_data);
+
+    drmEventContext context = {
+        .version = DRM_EVENT_CONTEXT_VERSION,
+        .page_flip_handler = page_flip_handler
+    };
+    drmHandleEvent(fd, &context);
+}
+
+
+/**
+ * Public functions
+ */
+
+bool ul_kms_init(int requested_buffers) {
+    num_buffers = LV_MAX(2, LV_MIN(requested_buffers, UL_KMS_MAX_BUFFERS));
+
+    drm_fd = open(DRM_CARD, O_RDWR | O_CLOEXEC);
+    if (drm_fd < 0) {
+        ul_log(UL_LOG_LEVEL_WARNING, "Could not open %s: %s", DRM_CARD, strerror(errno));
+        return false;
+    }
+
+    uint64_t has_dumb = 0;
+    if (drmGetCap(drm_fd, DRM_CAP_DUMB_BUFFER, &has_dumb) < 0 || !has_dumb || !find_output()) {
+        close(drm_fd);
+        drm_fd = -1;
+        return false;
+    }
+
+    int num_created = 0;
+    while (num_created < num_buffers && create_buffer(&(buffers[num_created]), mode.hdisplay, mode.vdisplay)) {
+        num_created++;
+    }
+
+    if (num_created < num_buffers
+        || drmModeSetCrtc(drm_fd, crtc_id, buffers[0].fb_id, 0, 0, &connector_id, 1, &mode) < 0
+        || !ul_loop_add_fd(drm_fd, drm_readable_cb, NULL)) {
+        ul_log(UL_LOG_LEVEL_WARNING, "Could not set up DRM page flipping");
+        for (int i = 0; i < num_created; ++i) {
+            destroy_buffer(&(buffers[i]));
+        }
+        close(drm_fd);
+        drm_fd = -1;
+        return false;
+    }
+
+    front = 0;
+    ul_log(UL_LOG_LEVEL_VERBOSE, "DRM output %ux%u@%u with %d buffers", mode.hdisplay, mode.vdisplay, mode.vrefresh,
+        num_buffers);
+
+    if (find_overlay_plane()) {
+        ul_log(UL_LOG_LEVEL_VERBOSE, "Using DRM overlay plane %u for sliding widgets", overlay_plane_id);
+    }
+    return true;
+}
+
+void ul_kms_get_sizes(uint32_t *hor_res, uint32_t *ver_res, uint32_t *dpi) {
+    if (hor_res) {
+        *hor_res = mode.hdisplay;
+    }
+    if (ver_res) {
+        *ver_res = mode.vdisplay;
+    }
+    if (dpi) {
+        *dpi = mm_width > 0 ? (uint32_t)(mode.hdisplay * 254 / (mm_width * 10)) : LV_DPI_DEF;
+    }
+}
+
+void ul_kms_add_damage(const lv_area_t *area) {
+    /* Every scanout buffer misses this area until it is copied in */
+    for (int i = 0; i < num_buffers; ++i) {
+        add_damage(&(buffers[i]), area);
+    }
+}
+
+void ul_kms_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p) {
+    shadow = color_p;
+    shadow_width = disp_drv->hor_res;
+    shadow_height = disp_drv->ver_res;
+
+    ul_kms_add_damage(area);
+
+    if (lv_disp_flush_is_last(disp_drv)) {
+        if (overlay_hide == OVERLAY_HIDE_REQUESTED) {
+            overlay_hide = OVERLAY_HIDE_RENDERED;
+        }
+        present_frame();
+    }
+
+    /* The draw buffer was not handed to the hardware, so LVGL can go on rendering right away */
+    lv_disp_flush_ready(disp_drv);
+}
+
+bool ul_kms_load_overlay(const lv_color_t *pixels, lv_coord_t stride, lv_coord_t width, lv_coord_t height) {
+    if (!overlay_plane_id || width <= 0 || height <= 0) {
+        return false;
+    }
+
+    if (width != overlay_width || height != overlay_height) {
+        disable_overlay();
+        if (overlay_buffer.handle) {
+            destroy_buffer(&overlay_buffer);
+        }
+        overlay_width = 0;
+        overlay_height = 0;
+        if (!create_buffer(&overlay_buffer, (uint32_t)width, (uint32_t)height)) {
+            return false;
+        }
+        overlay_width = width;
+        overlay_height = height;
+    }
+
+    const size_t row_size = (size_t)width * sizeof(lv_color_t);
+    for (lv_coord_t y = 0; y < height; ++y) {
+        memcpy(overlay_buffer.map + (size_t)y * overlay_buffer.pitch, &(pixels[(size_t)y * stride]), row_size);
+    }
+
+    overlay_hide = OVERLAY_HIDE_NONE;
+    return true;
+}
+
+bool ul_kms_move_overlay(lv_coord_t x, lv_coord_t y) {
+    overlay_hide = OVERLAY_HIDE_NONE;
+
+    /* Not every driver accepts planes reaching past the screen, so clip them here */
+    const lv_area_t screen = {
+        .x1 = 0,
+        .y1 = 0,
+        .x2 = (lv_coord_t)mode.hdisplay - 1,
+        .y2 = (lv_coord_t)mode.vdisplay - 1
+    };
+    const lv_area_t plane_area = { .x1 = x, .y1 = y, .x2 = x + overlay_width - 1, .y2 = y + overlay_height - 1 };
+    lv_area_t visible;
+    if (!_lv_area_intersect(&visible, &plane_area, &screen)) {
+        disable_overlay();
+        return true;
+    }
+
+    /* Source coordinates are in 16.16 fixed point */
+    const uint32_t width = (uint32_t)lv_area_get_width(&visible);
+    const uint32_t height = (uint32_t)lv_area_get_height(&visible);
+    if (drmModeSetPlane(drm_fd, overlay_plane_id, crtc_id, overlay_buffer.fb_id, 0, visible.x1, visible.y1, width,
+            height, (uint32_t)(visible.x1 - x) << 16, (uint32_t)(visible.y1 - y) << 16, width << 16,
+            height << 16) < 0) {
+        ul_log(UL_LOG_LEVEL_WARNING, "Could not show DRM overlay plane %u: %s", overlay_plane_id, strerror(errno));
+        disable_overlay();
+        overlay_plane_id = 0;
+        return false;
+    }
+
+    is_overlay_enabled = true;
+    return true;
+}
+
+void ul_kms_hide_overlay(void) {
+    if (is_overlay_enabled) {
+        overlay_hide = OVERLAY_HIDE_REQUESTED;
+    }
+}
+
+bool ul_kms_set_cursor(const lv_img_dsc_t *img) {
+    if (img->header.cf != LV_IMG_CF_TRUE_COLOR_ALPHA) {
+        return false;
+    }
+
+    /* Cursor planes only take images of their exact size, which drivers tend to keep at 64x64 */
+    uint64_t width = 64;
+    uint64_t height = 64;
+    drmGetCap(drm_fd, DRM_CAP_CURSOR_WIDTH, &width);
+    drmGetCap(drm_fd, DRM_CAP_CURSOR_HEIGHT, &height);
+    if (img->header.w > width || img->header.h > height) {
+        return false;
+    }
+
+    if (cursor_buffer.handle) {
+        destroy_buffer(&cursor_buffer);
+    }
+    if (!create_dumb_buffer(&cursor_buffer, (uint32_t)width, (uint32_t)height, 32)) {
+        return false;
+    }
+
+    /* The image holds each pixel's colour followed by its alpha byte, the plane wants premultiplied ARGB */
+    for (uint32_t y = 0; y < img->header.h; ++y) {
+        uint32_t *row = (uint32_t *)(cursor_buffer.map + (size_t)y * cursor_buffer.pitch);
+        for (uint32_t x = 0; x < img->header.w; ++x) {
+            const uint8_t *px = img->data + ((size_t)y * img->header.w + x) * LV_IMG_PX_SIZE_ALPHA_BYTE;
+            lv_color_t color;
+            memcpy(&color, px, sizeof(color));
+            lv_color32_t c32;
+            c32.full = lv_color_to32(color);
+            const uint32_t alpha = px[LV_IMG_PX_SIZE_ALPHA_BYTE - 1];
+            row[x] = alpha << 24 | (c32.ch.red * alpha / 255) << 16 | (c32.ch.green * alpha / 255) << 8
+                | c32.ch.blue * alpha / 255;
+        }
+    }
+
+    /* The hot spot is the image's top left corner, just like for LVGL's cursor object */
+    if (drmModeSetCursor2(drm_fd, crtc_id, cursor_buffer.handle, (uint32_t)width, (uint32_t)height, 0, 0) < 0
+        && drmModeSetCursor(drm_fd, crtc_id, cursor_buffer.handle, (uint32_t)width, (uint32_t)height) < 0) {
+        ul_log(UL_LOG_LEVEL_VERBOSE, "Could not set DRM cursor: %s", strerror(errno));
+        destroy_buffer(&cursor_buffer);
+        return false;
+    }
+
+    drmModeMoveCursor(drm_fd, crtc_id, 0, 0);
+    return true;
+}
+
+void ul_kms_move_cursor(lv_coord_t x, lv_coord_t y) {
+    if (cursor_buffer.handle) {
+        drmModeMoveCursor(drm_fd, crtc_id, x, y);
+    }
+}
@@ -0,0 +1,111 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_KMS_H
+#define UL_KMS_H
+
+#include "lvgl/lvgl.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Maximum number of scanout buffers */
+#define UL_KMS_MAX_BUFFERS 3
+
+/**
+ * Set up tear-free DRM output with page flipping between dumb buffers. LVGL renders into a full-screen buffer in
+ * direct mode and the changed areas are copied into a free scanout buffer, which is then flipped to at the next
+ * vertical blank. Flip completion is handled by the main loop, which must have been initialised already.
+ *
+ * @param num_buffers number of scanout buffers, 2 or 3
+ * @return true on success, false if the device could not be set up (nothing is left behind in that case)
+ */
+bool ul_kms_init(int num_buffers);
+
+/**
+ * Get the size of the display.
+ *
+ * @param hor_res pointer for writing the horizontal resolution
+ * @param ver_res pointer for writing the vertical resolution
+ * @param dpi pointer for writing the pixel density
+ */
+void ul_kms_get_sizes(uint32_t *hor_res, uint32_t *ver_res, uint32_t *dpi);
+
+/**
+ * Mark an area of the full-screen draw buffer as changed outside of LVGL's rendering, so that it is copied into the
+ * scanout buffers with the next frame.
+ *
+ * @param area changed area
+ */
+void ul_kms_add_damage(const lv_area_t *area);
+
+/**
+ * Flush callback for a display driver in direct mode with a single full-screen draw buffer.
+ *
+ * @param disp_drv display driver
+ * @param area area that was rendered
+ * @param color_p start of the full-screen draw buffer
+ */
+void ul_kms_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p);
+
+/**
+ * Load a picture into the overlay plane, replacing the previous one. Nothing is shown until the plane is moved.
+ *
+ * @param pixels first pixel of the picture
+ * @param stride distance between the picture's rows in pixels
+ * @param width width of the picture
+ * @param height height of the picture
+ * @return true on success, false if there is no overlay plane or its buffer could not be allocated
+ */
+bool ul_kms_load_overlay(const lv_color_t *pixels, lv_coord_t stride, lv_coord_t width, lv_coord_t height);
+
+/**
+ * Show the overlay plane with its top left corner at a screen position. Parts outside the screen are clipped and the
+ * plane is turned off while it is entirely outside.
+ *
+ * @param x horizontal position
+ * @param y vertical position
+ * @return true on success, false if the plane could not be shown (it is not used again in that case)
+ */
+bool ul_kms_move_overlay(lv_coord_t x, lv_coord_t y);
+
+/**
+ * Turn the overlay plane off once the next frame that is rendered is on screen, so that there is no gap between the
+ * plane disappearing and the frame showing its content.
+ */
+void ul_kms_hide_overlay(void);
+
+/**
+ * Upload an image to the hardware cursor plane and show it at the top left corner of the screen.
+ *
+ * @param img cursor image with an alpha channel, its top left corner being the hot spot
+ * @return true on success, false if the device has no cursor plane that can show the image
+ */
+bool ul_kms_set_cursor(const lv_img_dsc_t *img);
+
+/**
+ * Move the hardware cursor.
+ *
+ * @param x horizontal position of the hot spot
+ * @param y vertical position of the hot spot
+ */
+void ul_kms_move_cursor(lv_coord_t x, lv_coord_t y);
+
+#endif /* UL_KMS_H */
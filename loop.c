@@ -0,0 +1,232 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "loop.h"
+
+#include "log.h"
+
+#include "lvgl/lvgl.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+
+/**
+ * Defines
+ */
+
+#define MAX_EVENTS 8
+#define MAX_WATCHES 32
+
+/* A file descriptor the loop sleeps on */
+typedef struct {
+    int fd;
+    ul_loop_fd_cb callback;
+    void *user_data;
+} loop_watch;
+
+
+/**
+ * Static variables
+ */
+
+static int epoll_fd = -1;
+/* Armed to the deadline of the next LVGL timer */
+static int timer_fd = -1;
+/* Signalled by other threads through ul_loop_wake */
+static int wake_fd = -1;
+static ul_loop_wake_cb wake_callback = NULL;
+static loop_watch watches[MAX_WATCHES];
+static int num_watches = 0;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Arm the timer for the next LVGL timer deadline.
+ *
+ * @param delay milliseconds until the deadline or LV_NO_TIMER_READY to disarm the timer
+ */
+static void arm_timer(uint32_t delay);
+
+/**
+ * Drain the timerfd after it expired.
+ *
+ * @param fd the timerfd
+ * @param user_data unused
+ */
+static void timer_expired_cb(int fd, void *user_data);
+
+/**
+ * Drain the wakeup eventfd and notify the wake callback.
+ *
+ * @param fd the eventfd
+ * @param user_data unused
+ */
+static void wake_requested_cb(int fd, void *user_data);
+
+/**
+ * Find the watch of a file descriptor.
+ *
+ * @param fd file descriptor
+ * @return the watch or NULL if the file descriptor is not watched
+ */
+static loop_watch *find_watch(int fd);
+
+/**
+ * Stop the display refresh timer if nothing is waiting to be redrawn. Invalidating an area resumes it.
+ */
+static void pause_idle_refresh(void);
+
+
+/**
+ * Static functions
+ */
+
+static void arm_timer(uint32_t delay) {
+    struct itimerspec spec = { 0 };
+    if (delay != LV_NO_TIMER_READY) {
+        /* An all-zero value would disarm the timer, so a timer that is already due fires after 1 ns */
+        spec.it_value.tv_sec = delay / 1000;
+        spec.it_value.tv_nsec = (delay % 1000) * 1000000L;
+        if (delay == 0) {
+            spec.it_value.tv_nsec = 1;
+        }
+    }
+    timerfd_settime(timer_fd, 0, &spec, NULL);
+}
+
+static void timer_expired_cb(int fd, void *user_data) {
+    LV_UNUSED(user_data);
+    uint64_t expirations;
+    if (read(fd, &expirations, sizeof(expirations)) < 0) {
+        /* Spurious wakeup, nothing to drain */
+    }
+}
+
+static void wake_requested_cb(int fd, void *user_data) {
+    LV_UNUSED(user_data);
+    eventfd_t value;
+    eventfd_read(fd, &value);
+    if (wake_callback) {
+        wake_callback();
+    }
+}
+
+static loop_watch *find_watch(int fd) {
+    for (int i = 0; i < num_watches; ++i) {
+        if (watches[i].fd == fd) {
+            return &(watches[i]);
+        }
+    }
+    return NULL;
+}
+
+static void pause_idle_refresh(void) {
+    lv_disp_t *disp = lv_disp_get_default();
+    if (disp && disp->refr_timer && disp->inv_p == 0) {
+        lv_timer_pause(disp->refr_timer);
+    }
+}
+
+
+/**
+ * Public functions
+ */
+
+bool ul_loop_init(ul_loop_wake_cb wake_cb) {
+    wake_callback = wake_cb;
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (epoll_fd < 0 || timer_fd < 0 || wake_fd < 0) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not set up the main loop: %s", strerror(errno));
+        return false;
+    }
+
+    return ul_loop_add_fd(timer_fd, timer_expired_cb, NULL) && ul_loop_add_fd(wake_fd, wake_requested_cb, NULL);
+}
+
+bool ul_loop_add_fd(int fd, ul_loop_fd_cb callback, void *user_data) {
+    if (num_watches == MAX_WATCHES) {
+        ul_log(UL_LOG_LEVEL_WARNING, "Too many file descriptors to watch, ignoring %d", fd);
+        return false;
+    }
+
+    loop_watch *watch = &(watches[num_watches]);
+    watch->fd = fd;
+    watch->callback = callback;
+    watch->user_data = user_data;
+
+    struct epoll_event event = { .events = EPOLLIN, .data.ptr = watch };
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        ul_log(UL_LOG_LEVEL_WARNING, "Could not watch file descriptor %d: %s", fd, strerror(errno));
+        return false;
+    }
+
+    num_watches++;
+    return true;
+}
+
+void ul_loop_set_fd_enabled(int fd, bool is_enabled) {
+    loop_watch *watch = find_watch(fd);
+    if (!watch) {
+        return;
+    }
+
+    struct epoll_event event = { .events = is_enabled ? EPOLLIN : 0, .data.ptr = watch };
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &event);
+}
+
+void ul_loop_wake(void) {
+    eventfd_write(wake_fd, 1);
+}
+
+void ul_loop_run(void) {
+    struct epoll_event events[MAX_EVENTS];
+
+    while (1) {
+        uint32_t delay = lv_timer_handler();
+        pause_idle_refresh();
+        arm_timer(delay);
+
+        int num_events = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+        if (num_events < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ul_log(UL_LOG_LEVEL_ERROR, "Waiting for main loop events failed: %s", strerror(errno));
+            return;
+        }
+
+        for (int i = 0; i < num_events; ++i) {
+            loop_watch *watch = events[i].data.ptr;
+            watch->callback(watch->fd, watch->user_data);
+        }
+    }
+}
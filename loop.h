@@ -0,0 +1,68 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_LOOP_H
+#define UL_LOOP_H
+
+#include <stdbool.h>
+
+/* Called on the LVGL thread after another thread requested a wakeup */
+typedef void (*ul_loop_wake_cb)(void);
+
+/* Called on the LVGL thread when a watched file descriptor became readable */
+typedef void (*ul_loop_fd_cb)(int fd, void *user_data);
+
+/**
+ * Set up the main loop. Must be called on the LVGL thread before any file descriptor is watched.
+ *
+ * @param wake_cb function to call after ul_loop_wake, may be NULL
+ * @return true on success, false if the file descriptors could not be created
+ */
+bool ul_loop_init(ul_loop_wake_cb wake_cb);
+
+/**
+ * Watch a file descriptor for readability. Must be called on the LVGL thread.
+ *
+ * @param fd file descriptor
+ * @param callback function to call whenever the file descriptor is readable
+ * @param user_data data to pass to the callback
+ * @return true on success, false if the descriptor could not be watched
+ */
+bool ul_loop_add_fd(int fd, ul_loop_fd_cb callback, void *user_data);
+
+/**
+ * Temporarily stop or resume watching a file descriptor, e.g. while it is being read periodically anyway.
+ *
+ * @param fd file descriptor previously passed to ul_loop_add_fd
+ * @param is_enabled true to watch the file descriptor, false to ignore it
+ */
+void ul_loop_set_fd_enabled(int fd, bool is_enabled);
+
+/**
+ * Wake the main loop up from any thread.
+ */
+void ul_loop_wake(void);
+
+/**
+ * Run LVGL forever. The thread sleeps until the next LVGL timer is due or until ul_loop_wake is called.
+ */
+void ul_loop_run(void);
+
+#endif /* UL_LOOP_H */
@@ -21,23 +21,39 @@
 
 
 #include "backends.h"
+#include "blend.h"
 #include "command_line.h"
 #include "config.h"
+#include "convert.h"
+#include "cpu.h"
+#include "display.h"
+#include "flush.h"
 #include "indev.h"
 #include "log.h"
+#include "loop.h"
+#include "output.h"
+#include "pool.h"
+#include "rotate.h"
 #include "furios-terminal.h"
+#include "headless.h"
+#include "scan.h"
+#include "slide.h"
+#include "screen.h"
+#include "term_widget.h"
 #include "terminal.h"
 #include "theme.h"
 #include "themes.h"
-#include "termstr.h"
+#include "utf8.h"
 
 #include "lv_drv_conf.h"
 
 #if USE_FBDEV
 #include "lv_drivers/display/fbdev.h"
+#include "fb.h"
 #endif /* USE_FBDEV */
 #if USE_DRM
 #include "lv_drivers/display/drm.h"
+#include "kms.h"
 #endif /* USE_DRM */
 #if USE_MINUI
 #include "lv_drivers/display/minui.h"
@@ -45,16 +61,18 @@
 
 #include "lvgl/lvgl.h"
 
+#include "lvgl/src/widgets/keyboard/lv_keyboard_global.h"
+
 #include "squeek2lvgl/sq2lv.h"
 
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 #include <unistd.h>
 #include <ctype.h>
 
 #include <sys/reboot.h>
-#include <sys/time.h>
 
 /**
  * Static variables
@@ -70,18 +88,13 @@ bool is_keyboard_hidden = true;
 lv_obj_t *keyboard = NULL;
 lv_obj_t* t_box = NULL;
 
-#define MAX_TEXTAREA_LENGTH 9314
-#define UPDATE_INTERVAL 16666 // microseconds (approx. 60 FPS)
-#define BUFFER_SIZE 4096
+#define UPDATE_INTERVAL 16 // milliseconds (approx. 60 FPS)
+#define TERM_FONT (&lv_font_unscii_16)
 
-static char previous_content[BUFFER_SIZE] = {0};
-static struct timespec last_update_time = {0, 0};
+static ul_screen screen;
 
-pthread_t tty_update_thread;
-pthread_mutex_t tty_updater_mutex = PTHREAD_MUTEX_INITIALIZER;
-pthread_cond_t tty_cond = PTHREAD_COND_INITIALIZER;
-bool tty_thread_running = true;
-bool tty_update_needed = false;
+static lv_obj_t *term_view = NULL;
+static lv_timer_t *tty_timer = NULL;
 
 /**
  * Static prototypes
@@ -99,14 +112,6 @@ static void toggle_keyboard_hidden(void);
  */
 static void set_keyboard_hidden(bool is_hidden);
 
-/**
- * Callback for the keyboard's vertical slide in / out animation.
- *
- * @param obj keyboard widget
- * @param value y position
- */
-static void keyboard_anim_y_cb(void* obj, int32_t value);
-
 /**
  * Handle LV_EVENT_VALUE_CHANGED events from the keyboard widget.
  *
@@ -130,17 +135,31 @@ static void send_sig_term();
  */
 static void sigaction_handler(int signum);
 
-static void request_tty_update(void);
-
-static void update_tty(char * loc, int length, bool split);
-
-static void* tty_update_thread_func(void* arg);
+/**
+ * Drain all pending shell output into the terminal box. Runs once per frame on the LVGL thread.
+ *
+ * @param timer the timer that fired
+ */
+static void tty_timer_cb(lv_timer_t *timer);
 
-static void split_and_add_tty();
+/**
+ * Resume the TTY timer after the output thread woke the main loop up.
+ */
+static void loop_wake_cb(void);
 
-static void clean_illegal_chars(char *loc);
+/**
+ * Account for the output shown by a completed frame.
+ *
+ * @param disp_drv display driver
+ * @param time time it took to render the frame in milliseconds
+ * @param px number of pixels rendered
+ */
+static void monitor_cb(lv_disp_drv_t *disp_drv, uint32_t time, uint32_t px);
 
-static bool is_time_to_update();
+/**
+ * Log rendering statistics when the program exits.
+ */
+static void log_output_stats(void);
 
 static void back_button_event_handler(lv_event_t * e);
 
@@ -161,18 +180,9 @@ static void set_keyboard_hidden(bool is_hidden) {
         return;
     }
 
-    lv_anim_t keyboard_anim;
-    lv_anim_init(&keyboard_anim);
-    lv_anim_set_var(&keyboard_anim, keyboard);
-    lv_anim_set_values(&keyboard_anim, is_hidden ? 0 : lv_obj_get_height(keyboard), is_hidden ? lv_obj_get_y(keyboard) : 0);
-    lv_anim_set_path_cb(&keyboard_anim, lv_anim_path_ease_out);
-    lv_anim_set_time(&keyboard_anim, 500);
-    lv_anim_set_exec_cb(&keyboard_anim, keyboard_anim_y_cb);
-    lv_anim_start(&keyboard_anim);
-}
-
-static void keyboard_anim_y_cb(void* obj, int32_t value) {
-    lv_obj_set_y(obj, value);
+    /* Slide a picture of the keyboard instead of rendering it and the area it uncovers on every step */
+    ul_slide_start(keyboard, is_hidden ? 0 : lv_obj_get_height(keyboard), is_hidden ? lv_obj_get_y(keyboard) : 0, 500,
+        lv_anim_path_ease_out);
 }
 
 static void keyboard_value_changed_cb(lv_event_t *event) {
@@ -189,6 +199,14 @@ static void keyboard_value_changed_cb(lv_event_t *event) {
     }
 
     lv_keyboard_def_event_cb(event);
+    ul_terminal_process_keyboard_requests();
+
+    /* The keyboard keeps its own copy of the command, the text area only serves as its input target */
+    if (command_buffer_length == 0) {
+        lv_textarea_set_text(t_box, "");
+    }
+
+    ul_term_widget_set_preedit(term_view, command_buffer, command_buffer_length, command_buffer_pos);
 }
 
 static void keyboard_ready_cb(lv_event_t *event) {
@@ -205,124 +223,42 @@ static void sigaction_handler(int signum) {
     exit(0);
 }
 
-static void request_tty_update(void) {
-    pthread_mutex_lock(&tty_updater_mutex);
-    tty_update_needed = true;
-    pthread_cond_signal(&tty_cond);
-    pthread_mutex_unlock(&tty_updater_mutex);
-}
-
-static void update_tty_main_thread(void* buffer) {
-    update_tty((char*)buffer, BUFFER_SIZE, true);
-    lv_obj_invalidate(t_box);
-}
-
-static void* tty_update_thread_func(void* arg) {
-    LV_UNUSED(arg);
-
-    while (tty_thread_running) {
-        pthread_mutex_lock(&tty_updater_mutex);
-        while (!tty_update_needed && tty_thread_running) {
-            pthread_cond_wait(&tty_cond, &tty_updater_mutex);
-        }
-
-        if (!tty_thread_running) {
-            pthread_mutex_unlock(&tty_updater_mutex);
-            break;
-        }
-
-        tty_update_needed = false;
-        pthread_mutex_unlock(&tty_updater_mutex);
-
-        char* buffer = ul_terminal_update_interpret_buffer();
-
-        lv_async_call(update_tty_main_thread, buffer);
-    }
-    return NULL;
-}
-
-static void update_tty(char *loc, int length, bool split) {
-    if (!term_needs_update || length <= 0)
-        return;
+static void tty_timer_cb(lv_timer_t *timer) {
+    ul_terminal_process_keyboard_requests();
 
-    if (memcmp(loc, previous_content, length) == 0)
+    /* Output is parsed on its own thread, only pick up whatever state the screen is in by now. Sleep until
+     * the output thread wakes us up again once it has gone quiet. */
+    if (!ul_output_collect()) {
+        lv_timer_pause(timer);
         return;
-
-    if (strstr(loc, "\033[2J") != NULL) {
-        lv_textarea_set_text(t_box, "");
-    } else {
-        if (split && strlen(lv_textarea_get_text(t_box)) + length >= MAX_TEXTAREA_LENGTH) {
-            split_and_add_tty(loc);
-        } else {
-            size_t current_length = strlen(lv_textarea_get_text(t_box));
-            if (current_length >= MAX_TEXTAREA_LENGTH) {
-                size_t overflow = current_length + length - MAX_TEXTAREA_LENGTH;
-                if (overflow > 0) {
-                    lv_textarea_set_cursor_pos(t_box, 0);
-                    lv_textarea_del_char_forward(t_box);
-                    lv_textarea_set_cursor_pos(t_box, LV_TEXTAREA_CURSOR_LAST);
-                }
-            }
-
-            remove_escape_codes(loc);
-            clean_illegal_chars(loc);
-            lv_textarea_add_text(t_box, loc);
-        }
     }
-
-    if (split)
-        term_needs_update = false;
-
-    memcpy(previous_content, loc, length);
-    memset(loc, 0, length);
+    ul_term_widget_invalidate_dirty_rows(term_view);
 }
 
-static void split_and_add_tty()
-{
-    char *buffer = ul_terminal_update_interpret_buffer();
-    size_t buffer_len = strlen(buffer);
-    size_t chunk_size = BUFFER_SIZE / 2;
-    size_t chunks = (buffer_len + chunk_size - 1) / chunk_size;
-
-    for (size_t i = 0; i < chunks; i++) {
-        size_t start = i * chunk_size;
-        size_t end = (i + 1) * chunk_size;
-        if (end > buffer_len)
-            end = buffer_len;
-
-        pthread_mutex_lock(&tty_updater_mutex);
-        update_tty(buffer + start, end - start, false);
-        pthread_mutex_unlock(&tty_updater_mutex);
-    }
-
-    term_needs_update = false;
+static void loop_wake_cb(void) {
+    lv_timer_resume(tty_timer);
 }
 
-static inline void clean_illegal_chars(char *loc)
-{
-    unsigned char *src = (unsigned char *)loc;
-    unsigned char *dst = (unsigned char *)loc;
-
-    while (*src) {
-        if (*src >= 32 && *src <= 126)
-            *dst++ = *src;
-        src++;
-    }
-    *dst = '\0';
+static void monitor_cb(lv_disp_drv_t *disp_drv, uint32_t time, uint32_t px) {
+    LV_UNUSED(disp_drv);
+    LV_UNUSED(time);
+    LV_UNUSED(px);
+    ul_output_frame_rendered();
 }
 
-static inline bool is_time_to_update() {
-    struct timespec current_time;
-    clock_gettime(CLOCK_MONOTONIC, &current_time);
+static void log_output_stats(void) {
+    ul_log(UL_LOG_LEVEL_VERBOSE, "Left %llu output batches unrendered during output bursts",
+        (unsigned long long)ul_output_get_unrendered_batches());
 
-    long elapsed_us = (current_time.tv_sec - last_update_time.tv_sec) * 1000000 +
-                      (current_time.tv_nsec - last_update_time.tv_nsec) / 1000;
+    uint64_t hits, misses;
+    ul_term_widget_get_row_cache_stats(term_view, &hits, &misses);
+    ul_log(UL_LOG_LEVEL_VERBOSE, "Row cache served %llu terminal rows and missed %llu",
+        (unsigned long long)hits, (unsigned long long)misses);
 
-    if (elapsed_us >= UPDATE_INTERVAL) {
-        last_update_time = current_time;
-        return true;
+    if (conf_opts.general.backend == UL_BACKENDS_BACKEND_HEADLESS) {
+        ul_log(UL_LOG_LEVEL_VERBOSE, "Headless backend completed %llu frames",
+            (unsigned long long)ul_headless_get_frame_count());
     }
-    return false;
 }
 
 static void back_button_event_handler(lv_event_t * e) {
@@ -362,9 +298,33 @@ int main(int argc, char *argv[]) {
     /* Parse config files */
     ul_config_parse(cli_opts.config_files, cli_opts.num_config_files, &conf_opts);
 
+    /* Keep interrupt and suspend requests for the shell away from every thread started from here on */
+    ul_terminal_block_forwarded_signals();
+
+    /* Pick SIMD code paths before any thread is started */
+    ul_cpu_detect_features();
+    ul_scan_init();
+    ul_utf8_init();
+    ul_blend_init();
+    ul_convert_init();
+    ul_rotate_init();
+    ul_log(UL_LOG_LEVEL_VERBOSE,
+        "CPU features: %s, text scanner: %s, UTF-8 validator: %s, blender: %s, pixel converter: %s, rotator: %s",
+        ul_cpu_get_feature_names(), ul_scan_get_implementation_name(), ul_utf8_get_implementation_name(),
+        ul_blend_get_implementation_name(), ul_convert_get_implementation_name(), ul_rotate_get_implementation_name());
+
+    /* Start the threads that help drawing large areas of the terminal */
+    ul_pool_init(conf_opts.display.render_threads);
+    ul_log(UL_LOG_LEVEL_VERBOSE, "Rendering on %d threads", ul_pool_get_size());
+
     /* Initialise LVGL and set up logging callback */
     lv_init();
 
+    /* Set up the event loop before any backend or thread that may want to use it is started */
+    if (!ul_loop_init(loop_wake_cb)) {
+        exit(EXIT_FAILURE);
+    }
+
     /* Initialise display driver */
     static lv_disp_drv_t disp_drv;
     lv_disp_drv_init(&disp_drv);
@@ -373,10 +333,22 @@ int main(int argc, char *argv[]) {
     uint32_t hor_res = 0;
     uint32_t ver_res = 0;
     uint32_t dpi = 0;
+    /* Video memory that LVGL renders into directly, if any */
+    lv_color_t *direct_buf = NULL;
 
     switch (conf_opts.general.backend) {
 #if USE_FBDEV
     case UL_BACKENDS_BACKEND_FBDEV:
+        /* Render straight into video memory if its layout matches, otherwise convert while flushing. Overridden
+         * geometry is left to lv_drivers. */
+        if (cli_opts.hor_res <= 0 && cli_opts.ver_res <= 0 && cli_opts.x_offset == 0 && cli_opts.y_offset == 0
+            && ul_fb_init()) {
+            ul_fb_get_sizes(&hor_res, &ver_res, &dpi);
+            disp_drv.flush_cb = ul_fb_flush;
+            direct_buf = ul_fb_get_buffer();
+            disp_drv.direct_mode = direct_buf != NULL;
+            break;
+        }
         fbdev_init();
         fbdev_get_sizes(&hor_res, &ver_res, &dpi);
         disp_drv.flush_cb = fbdev_flush;
@@ -384,6 +356,22 @@ int main(int argc, char *argv[]) {
 #endif /* USE_FBDEV */
 #if USE_DRM
     case UL_BACKENDS_BACKEND_DRM:
+        /* Prefer page flipping and fall back to lv_drivers' single buffer if it cannot be set up */
+        if (conf_opts.drm.buffers >= 2 && ul_kms_init(conf_opts.drm.buffers)) {
+            ul_kms_get_sizes(&hor_res, &ver_res, &dpi);
+            disp_drv.flush_cb = ul_kms_flush;
+            disp_drv.direct_mode = 1;
+            /* The frame is a shadow buffer in cached memory, unlike fbdev's video memory which is cheaper to redraw
+             * than to read back */
+            ul_display_set_damage_cb(ul_kms_add_damage);
+            ul_display_set_move_enabled(true);
+            /* Hardware planes are placed in physical coordinates */
+            if (conf_opts.general.rotation == LV_DISP_ROT_NONE) {
+                ul_slide_set_plane(ul_kms_load_overlay, ul_kms_move_overlay, ul_kms_hide_overlay);
+                ul_indev_set_cursor_plane(ul_kms_set_cursor, ul_kms_move_cursor);
+            }
+            break;
+        }
         drm_init();
         drm_get_sizes((lv_coord_t *)&hor_res, (lv_coord_t *)&ver_res, &dpi);
         disp_drv.flush_cb = drm_flush;
@@ -396,6 +384,13 @@ int main(int argc, char *argv[]) {
         disp_drv.flush_cb = minui_flush;
         break;
 #endif /* USE_MINUI */
+    case UL_BACKENDS_BACKEND_HEADLESS:
+        if (!ul_headless_init(LV_MAX(cli_opts.hor_res, 0), LV_MAX(cli_opts.ver_res, 0), conf_opts.headless.dump)) {
+            exit(EXIT_FAILURE);
+        }
+        ul_headless_get_sizes(&hor_res, &ver_res, &dpi);
+        disp_drv.flush_cb = ul_headless_flush;
+        break;
     default:
         ul_log(UL_LOG_LEVEL_ERROR, "Unable to find suitable backend");
         exit(EXIT_FAILURE);
@@ -412,11 +407,47 @@ int main(int argc, char *argv[]) {
         dpi = cli_opts.dpi;
     }
 
+    /* Render upright and rotate each flushed chunk into the device's orientation. Direct mode devices keep their
+     * full-screen buffer in physical orientation, which for video memory means rotating straight into it. */
+    bool is_device_direct = disp_drv.direct_mode;
+    if (conf_opts.general.rotation != LV_DISP_ROT_NONE) {
+        lv_color_t *frame = NULL;
+        if (disp_drv.direct_mode) {
+            frame = direct_buf ? direct_buf : (lv_color_t *)malloc((size_t)hor_res * ver_res * sizeof(lv_color_t));
+            if (!frame) {
+                ul_log(UL_LOG_LEVEL_ERROR, "Could not allocate the rotated frame");
+                exit(EXIT_FAILURE);
+            }
+        }
+        ul_rotate_start(&disp_drv, conf_opts.general.rotation, hor_res, ver_res, frame);
+        direct_buf = NULL;
+
+        if (conf_opts.general.rotation != LV_DISP_ROT_180) {
+            const uint32_t physical_hor_res = hor_res;
+            hor_res = ver_res;
+            ver_res = physical_hor_res;
+        }
+        ul_indev_set_rotation(conf_opts.general.rotation);
+    }
+
     /* Prepare display buffer */
-    const size_t buf_size = hor_res * ver_res / 10; /* At least 1/10 of the display size is recommended */
+    /* Direct mode needs a buffer covering the whole screen, otherwise at least 1/10 of the display size is recommended */
+    const size_t buf_size = disp_drv.direct_mode ? hor_res * ver_res : hor_res * ver_res / 10;
     lv_disp_draw_buf_t disp_buf;
-    lv_color_t *buf = (lv_color_t *)malloc(buf_size * sizeof(lv_color_t));
-    lv_disp_draw_buf_init(&disp_buf, buf, NULL, buf_size);
+    lv_color_t *buf = direct_buf ? direct_buf : (lv_color_t *)malloc(buf_size * sizeof(lv_color_t));
+    lv_color_t *buf2 = NULL;
+
+    /* With more than one core, copy each chunk to the device on a worker while the next one is rendered. Devices
+     * that take the whole screen, even behind the rotation, present frames and keep state that the main loop
+     * shares, so their flushes stay on the LVGL thread. */
+    if (!is_device_direct && sysconf(_SC_NPROCESSORS_ONLN) > 1) {
+        buf2 = (lv_color_t *)malloc(buf_size * sizeof(lv_color_t));
+        if (buf2 && !ul_flush_start(&disp_drv)) {
+            free(buf2);
+            buf2 = NULL;
+        }
+    }
+    lv_disp_draw_buf_init(&disp_buf, buf, buf2, buf_size);
 
     /* Register display driver */
     disp_drv.draw_buf = &disp_buf;
@@ -425,7 +456,11 @@ int main(int argc, char *argv[]) {
     disp_drv.offset_x = cli_opts.x_offset;
     disp_drv.offset_y = cli_opts.y_offset;
     disp_drv.dpi = dpi;
-    lv_disp_drv_register(&disp_drv);
+    disp_drv.monitor_cb = monitor_cb;
+    lv_disp_t *disp = lv_disp_drv_register(&disp_drv);
+    ul_blend_set_up_display(disp);
+    ul_log(UL_LOG_LEVEL_VERBOSE, "Display of %ux%u pixels at %u dpi, rendering with %d bits per pixel into %s",
+        hor_res, ver_res, dpi, LV_COLOR_DEPTH, disp_drv.direct_mode ? "the whole screen" : "partial buffers");
 
     /* Connect input devices */
     ul_indev_auto_connect(conf_opts.input.keyboard, conf_opts.input.pointer, conf_opts.input.touchscreen);
@@ -486,17 +521,27 @@ int main(int argc, char *argv[]) {
     lv_label_set_text(furios_label, "FuriOS Terminal");
     lv_obj_align(furios_label, LV_ALIGN_TOP_MID, 0, 50);
 
-    /* Terminal box */
+    /* Terminal view */
+    term_view = ul_term_widget_create(lv_scr_act());
+    lv_obj_align(term_view, LV_ALIGN_TOP_MID, 0, 100);
+    lv_obj_set_size(term_view, hor_res, ver_res-100-keyboard_height);
+    ul_term_widget_set_font(term_view, TERM_FONT);
+    ul_term_widget_set_row_cache_size(term_view, (size_t)conf_opts.display.row_cache_kb * 1024);
+
+    lv_coord_t cell_width, cell_height;
+    ul_term_widget_get_cell_size(term_view, &cell_width, &cell_height);
+    const int term_cols = hor_res / cell_width;
+    const int term_rows = (ver_res - 100 - keyboard_height) / cell_height;
+    if (!ul_screen_init(&screen, term_rows, term_cols, conf_opts.terminal.scrollback_lines)) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not allocate the terminal screen");
+        exit(EXIT_FAILURE);
+    }
+    ul_output_init(&screen);
+    ul_term_widget_set_screen(term_view, &screen);
+
+    /* Hidden input target for the keyboard */
     t_box = lv_textarea_create(lv_scr_act());
-    static lv_style_t t_box_style;
-    lv_style_init(&t_box_style);
-    lv_style_set_bg_color(&t_box_style, lv_color_black());
-    lv_style_set_text_color(&t_box_style, lv_color_white());
-    lv_style_set_border_color(&t_box_style, lv_color_black());
-    lv_obj_add_style(t_box, &t_box_style, LV_PART_MAIN | LV_STATE_DEFAULT);
-    lv_obj_refresh_style(t_box, LV_PART_MAIN,LV_STYLE_PROP_ANY);
-    lv_obj_align(t_box, LV_ALIGN_TOP_MID, 0, 100);
-    lv_obj_set_size(t_box, hor_res, ver_res-100-keyboard_height);
+    lv_obj_add_flag(t_box, LV_OBJ_FLAG_HIDDEN);
     lv_event_send(t_box, LV_EVENT_FOCUSED, NULL);
 
     /* Keyboard */
@@ -513,29 +558,16 @@ int main(int argc, char *argv[]) {
     toggle_keyboard_hidden();
 
 
-    if (!ul_terminal_prepare_current_terminal((int)lv_obj_get_width(t_box),(int)lv_obj_get_height(t_box)))
-        lv_textarea_add_text(t_box, "Could not prepare the terminal!");
-
-    clock_gettime(CLOCK_MONOTONIC, &last_update_time);
-
-    if (pthread_create(&tty_update_thread, NULL, tty_update_thread_func, NULL) != 0) {
-        ul_log(UL_LOG_LEVEL_ERROR, "Failed to create TTY update thread");
-        exit(EXIT_FAILURE);
+    if (!ul_terminal_prepare_current_terminal(screen.cols, screen.rows) || !ul_output_start()) {
+        const char *message = "Could not prepare the terminal!";
+        ul_output_feed(message, strlen(message));
     }
+    atexit(log_output_stats);
 
-    while(1) {
-        lv_task_handler();
-        if (is_time_to_update())
-            request_tty_update();
-
-        usleep(500);
-    }
+    tty_timer = lv_timer_create(tty_timer_cb, UPDATE_INTERVAL, NULL);
 
-    tty_thread_running = false;
-    pthread_cond_signal(&tty_cond);
-    pthread_join(tty_update_thread, NULL);
-    pthread_mutex_destroy(&tty_updater_mutex);
-    pthread_cond_destroy(&tty_cond);
+    /* Sleep until an LVGL timer is due or another thread has news */
+    ul_loop_run();
 
     return 0;
 }
@@ -551,17 +583,18 @@ int main(int argc, char *argv[]) {
  * @return tick in ms
  */
 uint32_t ul_get_tick(void) {
+    /* Use the same clock as the main loop's timerfd so that deadlines line up */
     static uint64_t start_ms = 0;
     if (start_ms == 0) {
-        struct timeval tv_start;
-        gettimeofday(&tv_start, NULL);
-        start_ms = (tv_start.tv_sec * 1000000 + tv_start.tv_usec) / 1000;
+        struct timespec ts_start;
+        clock_gettime(CLOCK_MONOTONIC, &ts_start);
+        start_ms = (uint64_t)ts_start.tv_sec * 1000 + ts_start.tv_nsec / 1000000;
     }
 
-    struct timeval tv_now;
-    gettimeofday(&tv_now, NULL);
+    struct timespec ts_now;
+    clock_gettime(CLOCK_MONOTONIC, &ts_now);
     uint64_t now_ms;
-    now_ms = (tv_now.tv_sec * 1000000 + tv_now.tv_usec) / 1000;
+    now_ms = (uint64_t)ts_now.tv_sec * 1000 + ts_now.tv_nsec / 1000000;
 
     uint32_t time_ms = now_ms - start_ms;
     return time_ms;
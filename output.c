@@ -0,0 +1,152 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "output.h"
+
+#include "log.h"
+#include "loop.h"
+#include "terminal.h"
+#include "vt_parser.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#include <sys/eventfd.h>
+
+
+/**
+ * Defines
+ */
+
+/* Maximum number of bytes parsed while holding the screen lock. Bounds the time the renderer may have to wait. */
+#define CHUNK_SIZE (64 * 1024)
+
+
+/**
+ * Static variables
+ */
+
+static ul_screen *output_screen = NULL;
+static ul_vt_parser parser;
+static char chunk[CHUNK_SIZE];
+static pthread_t output_id;
+
+/* Number of output batches applied to the screen so far */
+static atomic_uint_fast64_t generation = 0;
+/* Batch that was current when the screen was last picked up for drawing. Only touched by the LVGL thread. */
+static uint64_t collected_generation = 0;
+/* Batch shown by the last completed frame. Only touched by the LVGL thread. */
+static uint64_t rendered_generation = 0;
+static atomic_uint_fast64_t unrendered_batches = 0;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Parse shell output until the program exits.
+ *
+ * @param arg unused
+ * @return never returns
+ */
+static void *output_thread(void *arg);
+
+
+/**
+ * Static functions
+ */
+
+static void *output_thread(void *arg) {
+    LV_UNUSED(arg);
+    int output_fd = ul_terminal_get_output_fd();
+
+    while (1) {
+        /* Sleep until the TTY thread hands over more output */
+        eventfd_t value;
+        if (eventfd_read(output_fd, &value) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ul_log(UL_LOG_LEVEL_ERROR, "Waiting for shell output failed: %s", strerror(errno));
+            break;
+        }
+
+        /* Drain everything that is pending, the renderer only ever picks up the latest state */
+        size_t length;
+        while ((length = ul_terminal_read_output(chunk, CHUNK_SIZE)) > 0) {
+            ul_screen_lock(output_screen);
+            ul_vt_parser_feed(&parser, chunk, length);
+            ul_screen_unlock(output_screen);
+            atomic_fetch_add(&generation, 1);
+            ul_loop_wake();
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * Public functions
+ */
+
+void ul_output_init(ul_screen *screen) {
+    output_screen = screen;
+    ul_vt_parser_init(&parser, ul_screen_handle_action, screen);
+}
+
+bool ul_output_start(void) {
+    if (pthread_create(&output_id, NULL, output_thread, NULL) != 0) {
+        ul_log(UL_LOG_LEVEL_WARNING, "Could not start output thread");
+        return false;
+    }
+    return true;
+}
+
+void ul_output_feed(const char *data, size_t length) {
+    ul_screen_lock(output_screen);
+    ul_vt_parser_feed(&parser, data, length);
+    ul_screen_unlock(output_screen);
+    atomic_fetch_add(&generation, 1);
+    ul_loop_wake();
+}
+
+bool ul_output_collect(void) {
+    uint64_t current = atomic_load(&generation);
+    if (current == collected_generation) {
+        return false;
+    }
+    collected_generation = current;
+    return true;
+}
+
+void ul_output_frame_rendered(void) {
+    if (collected_generation - rendered_generation > 1) {
+        atomic_fetch_add(&unrendered_batches, collected_generation - rendered_generation - 1);
+    }
+    rendered_generation = collected_generation;
+}
+
+uint64_t ul_output_get_unrendered_batches(void) {
+    return atomic_load(&unrendered_batches);
+}
@@ -0,0 +1,74 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_OUTPUT_H
+#define UL_OUTPUT_H
+
+#include "screen.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Set up the parser that turns shell output into screen updates.
+ *
+ * @param screen screen to update
+ */
+void ul_output_init(ul_screen *screen);
+
+/**
+ * Start a thread that parses shell output as fast as it arrives and wakes the main loop after every batch. From
+ * then on the screen must only be accessed while holding its lock.
+ *
+ * @return true on success, false if the thread could not be started
+ */
+bool ul_output_start(void);
+
+/**
+ * Parse text produced by the program itself, e.g. error messages, as if the shell had written it.
+ *
+ * @param data text to parse
+ * @param length length of the text
+ */
+void ul_output_feed(const char *data, size_t length);
+
+/**
+ * Note that the current screen state is being picked up for the next frame.
+ *
+ * @return true if output was parsed since the state was last picked up
+ */
+bool ul_output_collect(void);
+
+/**
+ * Note that the display completed a frame. Output batches that were parsed since the previous frame, apart from the
+ * last one picked up, never made it onto the display and are counted as unrendered.
+ */
+void ul_output_frame_rendered(void);
+
+/**
+ * Get the number of output batches whose screen state was never drawn because output arrived faster than the
+ * display refreshed.
+ *
+ * @return number of unrendered output batches
+ */
+uint64_t ul_output_get_unrendered_batches(void);
+
+#endif /* UL_OUTPUT_H */
@@ -0,0 +1,179 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "pool.h"
+
+#include "log.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <unistd.h>
+
+
+/**
+ * Defines
+ */
+
+/* Thread count used when there are enough cores. Beyond this, memory bandwidth rather than the cores limits. */
+#define DEFAULT_THREADS 4
+
+
+/**
+ * Static variables
+ */
+
+static pthread_t worker_ids[UL_POOL_MAX_THREADS - 1];
+static int num_workers = 0;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+/* Signalled when a batch was started */
+static pthread_cond_t batch_cond = PTHREAD_COND_INITIALIZER;
+/* Signalled when the last worker left a batch */
+static pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+
+/* Current batch, changed under the lock */
+static uint64_t batch_id = 0;
+static ul_pool_job_cb batch_job_cb = NULL;
+static void *batch_user_data = NULL;
+static size_t batch_count = 0;
+/* Workers that have not finished the current batch yet */
+static int num_busy_workers = 0;
+/* Next job of the current batch that nobody claimed yet */
+static atomic_size_t next_job = 0;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Wait for batches and help running them until the program exits.
+ *
+ * @param arg unused
+ * @return never returns
+ */
+static void *worker_thread(void *arg);
+
+/**
+ * Claim and run jobs of the current batch until none are left.
+ *
+ * @param job_cb job function
+ * @param user_data data to pass to the job function
+ * @param count number of jobs in the batch
+ */
+static void run_jobs(ul_pool_job_cb job_cb, void *user_data, size_t count);
+
+
+/**
+ * Static functions
+ */
+
+static void *worker_thread(void *arg) {
+    (void)arg;
+    uint64_t seen_batch_id = 0;
+
+    while (true) {
+        pthread_mutex_lock(&lock);
+        while (batch_id == seen_batch_id) {
+            pthread_cond_wait(&batch_cond, &lock);
+        }
+        seen_batch_id = batch_id;
+        ul_pool_job_cb job_cb = batch_job_cb;
+        void *user_data = batch_user_data;
+        size_t count = batch_count;
+        pthread_mutex_unlock(&lock);
+
+        run_jobs(job_cb, user_data, count);
+
+        pthread_mutex_lock(&lock);
+        if (--num_busy_workers == 0) {
+            pthread_cond_signal(&done_cond);
+        }
+        pthread_mutex_unlock(&lock);
+    }
+
+    return NULL;
+}
+
+static void run_jobs(ul_pool_job_cb job_cb, void *user_data, size_t count) {
+    size_t index;
+    while ((index = atomic_fetch_add(&next_job, 1)) < count) {
+        job_cb(index, user_data);
+    }
+}
+
+
+/**
+ * Public functions
+ */
+
+bool ul_pool_init(int num_threads) {
+    if (num_threads <= 0) {
+        long num_cores = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = num_cores > DEFAULT_THREADS ? DEFAULT_THREADS : (int)num_cores;
+    }
+    if (num_threads > UL_POOL_MAX_THREADS) {
+        num_threads = UL_POOL_MAX_THREADS;
+    }
+
+    while (num_workers < num_threads - 1) {
+        if (pthread_create(&(worker_ids[num_workers]), NULL, worker_thread, NULL) != 0) {
+            ul_log(UL_LOG_LEVEL_WARNING, "Could not start render thread %d", num_workers + 1);
+            break;
+        }
+        num_workers++;
+    }
+
+    return num_threads <= 1 || num_workers > 0;
+}
+
+int ul_pool_get_size(void) {
+    return num_workers + 1;
+}
+
+void ul_pool_run(size_t count, ul_pool_job_cb job_cb, void *user_data) {
+    if (num_workers == 0 || count <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            job_cb(i, user_data);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&lock);
+    batch_job_cb = job_cb;
+    batch_user_data = user_data;
+    batch_count = count;
+    atomic_store(&next_job, 0);
+    num_busy_workers = num_workers;
+    batch_id++;
+    pthread_cond_broadcast(&batch_cond);
+    pthread_mutex_unlock(&lock);
+
+    run_jobs(job_cb, user_data, count);
+
+    /* Workers may still be in the middle of their last job */
+    pthread_mutex_lock(&lock);
+    while (num_busy_workers > 0) {
+        pthread_cond_wait(&done_cond, &lock);
+    }
+    pthread_mutex_unlock(&lock);
+}
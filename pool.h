@@ -0,0 +1,59 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef UL_POOL_H
+#define UL_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Maximum number of threads that render in parallel, including the LVGL thread */
+#define UL_POOL_MAX_THREADS 8
+
+/* Job of a batch, called with the job's index */
+typedef void (*ul_pool_job_cb)(size_t index, void *user_data);
+
+/**
+ * Start the worker threads.
+ *
+ * @param num_threads total number of threads to use including the calling one, 0 to pick one per core (at most 4)
+ * @return true on success, false if no worker could be started (batches then run on the calling thread)
+ */
+bool ul_pool_init(int num_threads);
+
+/**
+ * Get the number of threads that run batches, including the calling one.
+ *
+ * @return thread count, 1 if there are no workers
+ */
+int ul_pool_get_size(void);
+
+/**
+ * Run a batch of independent jobs and wait for all of them to finish. The calling thread takes part, every thread
+ * keeps grabbing the next unclaimed job until none are left, so uneven jobs even out. Must not be called from a job.
+ *
+ * @param count number of jobs
+ * @param job_cb function to call for every job
+ * @param user_data data to pass to the job function
+ */
+void ul_pool_run(size_t count, ul_pool_job_cb job_cb, void *user_data);
+
+#endif /* UL_POOL_H */
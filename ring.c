@@ -0,0 +1,113 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "ring.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * Public functions
+ */
+
+bool ul_ring_init(ul_ring *ring, size_t size) {
+    size_t capacity = 1;
+    while (capacity < size) {
+        capacity <<= 1;
+    }
+
+    ring->data = malloc(capacity);
+    if (!ring->data) {
+        return false;
+    }
+
+    ring->size = capacity;
+    atomic_init(&(ring->head), 0);
+    atomic_init(&(ring->tail), 0);
+    return true;
+}
+
+void ul_ring_destroy(ul_ring *ring) {
+    free(ring->data);
+    ring->data = NULL;
+    ring->size = 0;
+}
+
+size_t ul_ring_readable(ul_ring *ring) {
+    size_t head = atomic_load_explicit(&(ring->head), memory_order_acquire);
+    size_t tail = atomic_load_explicit(&(ring->tail), memory_order_relaxed);
+    return head - tail;
+}
+
+size_t ul_ring_writable(ul_ring *ring) {
+    size_t head = atomic_load_explicit(&(ring->head), memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&(ring->tail), memory_order_acquire);
+    return ring->size - (head - tail);
+}
+
+size_t ul_ring_write(ul_ring *ring, const void *src, size_t length) {
+    size_t head = atomic_load_explicit(&(ring->head), memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&(ring->tail), memory_order_acquire);
+
+    size_t free_bytes = ring->size - (head - tail);
+    if (length > free_bytes) {
+        length = free_bytes;
+    }
+    if (length == 0) {
+        return 0;
+    }
+
+    /* Copy in at most two pieces, splitting where the storage wraps around */
+    size_t offset = head & (ring->size - 1);
+    size_t first = ring->size - offset;
+    if (first > length) {
+        first = length;
+    }
+    memcpy(ring->data + offset, src, first);
+    memcpy(ring->data, (const uint8_t *)src + first, length - first);
+
+    atomic_store_explicit(&(ring->head), head + length, memory_order_release);
+    return length;
+}
+
+size_t ul_ring_read(ul_ring *ring, void *dst, size_t length) {
+    size_t tail = atomic_load_explicit(&(ring->tail), memory_order_relaxed);
+    size_t head = atomic_load_explicit(&(ring->head), memory_order_acquire);
+
+    size_t used_bytes = head - tail;
+    if (length > used_bytes) {
+        length = used_bytes;
+    }
+    if (length == 0) {
+        return 0;
+    }
+
+    size_t offset = tail & (ring->size - 1);
+    size_t first = ring->size - offset;
+    if (first > length) {
+        first = length;
+    }
+    memcpy(dst, ring->data + offset, first);
+    memcpy((uint8_t *)dst + first, ring->data, length - first);
+
+    atomic_store_explicit(&(ring->tail), tail + length, memory_order_release);
+    return length;
+}
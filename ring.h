@@ -0,0 +1,96 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_RING_H
+#define UL_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Lock-free single-producer / single-consumer byte ring. Exactly one thread may write and exactly one
+ * (other) thread may read. The head is only advanced by the producer and the tail only by the consumer.
+ */
+typedef struct {
+    /* Backing storage */
+    uint8_t *data;
+    /* Capacity in bytes, always a power of two */
+    size_t size;
+    /* Total number of bytes ever written, owned by the producer */
+    _Alignas(64) atomic_size_t head;
+    /* Total number of bytes ever read, owned by the consumer */
+    _Alignas(64) atomic_size_t tail;
+} ul_ring;
+
+/**
+ * Allocate the storage of a ring.
+ *
+ * @param ring ring to initialise
+ * @param size capacity in bytes, rounded up to the next power of two
+ * @return true on success, false if the storage could not be allocated
+ */
+bool ul_ring_init(ul_ring *ring, size_t size);
+
+/**
+ * Release the storage of a ring.
+ *
+ * @param ring ring to destroy
+ */
+void ul_ring_destroy(ul_ring *ring);
+
+/**
+ * Get the number of bytes that can currently be read. Consumer side.
+ *
+ * @param ring ring to query
+ * @return number of readable bytes
+ */
+size_t ul_ring_readable(ul_ring *ring);
+
+/**
+ * Get the number of bytes that can currently be written. Producer side.
+ *
+ * @param ring ring to query
+ * @return number of writable bytes
+ */
+size_t ul_ring_writable(ul_ring *ring);
+
+/**
+ * Copy bytes into the ring. Producer side.
+ *
+ * @param ring ring to write into
+ * @param src bytes to write
+ * @param length number of bytes to write
+ * @return number of bytes actually written (less than length if the ring is full)
+ */
+size_t ul_ring_write(ul_ring *ring, const void *src, size_t length);
+
+/**
+ * Copy bytes out of the ring. Consumer side.
+ *
+ * @param ring ring to read from
+ * @param dst buffer to read into
+ * @param length maximum number of bytes to read
+ * @return number of bytes actually read
+ */
+size_t ul_ring_read(ul_ring *ring, void *dst, size_t length);
+
+#endif /* UL_RING_H */
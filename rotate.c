@@ -0,0 +1,456 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "rotate.h"
+
+#include "cpu.h"
+#include "log.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if LV_COLOR_DEPTH == 32 && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_X86_ROTATORS 1
+#endif
+
+#if LV_COLOR_DEPTH == 32 && defined(__aarch64__)
+#include <arm_neon.h>
+#define HAVE_NEON_ROTATORS 1
+#endif
+
+
+/**
+ * Defines
+ */
+
+/* Edge length of the square tiles that transposes work through, so that the rows being read and the rows being
+ * written both stay in the L1 cache */
+#define TILE_SIZE 32
+
+/* Transpose signature, writes dst[x * dst_stride + y] = src[y * src_stride + x]. Strides are in pixels and may be
+ * negative to mirror the image at the same time. */
+typedef void (*transpose_fn)(lv_color_t *dst, ptrdiff_t dst_stride, const lv_color_t *src, ptrdiff_t src_stride,
+    lv_coord_t width, lv_coord_t height);
+
+/* Mirror signature, writes dst[x] = src[count - 1 - x] */
+typedef void (*reverse_fn)(lv_color_t *dst, const lv_color_t *src, lv_coord_t count);
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Transpose a rectangle one pixel at a time.
+ *
+ * @param dst first pixel to write
+ * @param dst_stride distance between consecutive rows at dst in pixels
+ * @param src first pixel to read
+ * @param src_stride distance between consecutive rows at src in pixels
+ * @param x1 first column of src to transpose
+ * @param x2 column of src after the last one to transpose
+ * @param y1 first row of src to transpose
+ * @param y2 row of src after the last one to transpose
+ */
+static void transpose_block(lv_color_t *dst, ptrdiff_t dst_stride, const lv_color_t *src, ptrdiff_t src_stride,
+    lv_coord_t x1, lv_coord_t x2, lv_coord_t y1, lv_coord_t y2);
+
+/**
+ * Portable transpose working through the image tile by tile.
+ *
+ * @param dst first pixel to write
+ * @param dst_stride distance between consecutive rows at dst in pixels
+ * @param src first pixel to read
+ * @param src_stride distance between consecutive rows at src in pixels
+ * @param width number of columns of src
+ * @param height number of rows of src
+ */
+static void transpose_scalar(lv_color_t *dst, ptrdiff_t dst_stride, const lv_color_t *src, ptrdiff_t src_stride,
+    lv_coord_t width, lv_coord_t height);
+
+/**
+ * Portable mirror working on one pixel at a time.
+ *
+ * @param dst pixels to write
+ * @param src pixels to read
+ * @param count number of pixels
+ */
+static void reverse_scalar(lv_color_t *dst, const lv_color_t *src, lv_coord_t count);
+
+#if HAVE_X86_ROTATORS
+/**
+ * SSE2 transpose working on blocks of 4x4 pixels within each tile.
+ *
+ * @param dst first pixel to write
+ * @param dst_stride distance between consecutive rows at dst in pixels
+ * @param src first pixel to read
+ * @param src_stride distance between consecutive rows at src in pixels
+ * @param width number of columns of src
+ * @param height number of rows of src
+ */
+static void transpose_sse2(lv_color_t *dst, ptrdiff_t dst_stride, const lv_color_t *src, ptrdiff_t src_stride,
+    lv_coord_t width, lv_coord_t height);
+
+/**
+ * SSE2 mirror working on 4 pixels at a time.
+ *
+ * @param dst pixels to write
+ * @param src pixels to read
+ * @param count number of pixels
+ */
+static void reverse_sse2(lv_color_t *dst, const lv_color_t *src, lv_coord_t count);
+#endif /* HAVE_X86_ROTATORS */
+
+#if HAVE_NEON_ROTATORS
+/**
+ * NEON transpose working on blocks of 4x4 pixels within each tile.
+ *
+ * @param dst first pixel to write
+ * @param dst_stride distance between consecutive rows at dst in pixels
+ * @param src first pixel to read
+ * @param src_stride distance between consecutive rows at src in pixels
+ * @param width number of columns of src
+ * @param height number of rows of src
+ */
+static void transpose_neon(lv_color_t *dst, ptrdiff_t dst_stride, const lv_color_t *src, ptrdiff_t src_stride,
+    lv_coord_t width, lv_coord_t height);
+
+/**
+ * NEON mirror working on 4 pixels at a time.
+ *
+ * @param dst pixels to write
+ * @param src pixels to read
+ * @param count number of pixels
+ */
+static void reverse_neon(lv_color_t *dst, const lv_color_t *src, lv_coord_t count);
+#endif /* HAVE_NEON_ROTATORS */
+
+/**
+ * Map an area of the upright screen to physical coordinates.
+ *
+ * @param area area in LVGL's coordinates
+ * @param rotated pointer for writing the area on the panel into
+ */
+static void rotate_area(const lv_area_t *area, lv_area_t *rotated);
+
+/**
+ * Rotate the pixels of an area.
+ *
+ * @param dst first pixel of the rotated area to write
+ * @param dst_stride distance between consecutive rows at dst in pixels
+ * @param src first pixel of the upright area to read
+ * @param src_stride distance between consecutive rows at src in pixels
+ * @param area_width width of the upright area
+ * @param area_height height of the upright area
+ */
+static void rotate_pixels(lv_color_t *dst, ptrdiff_t dst_stride, const lv_color_t *src, ptrdiff_t src_stride,
+    lv_coord_t area_width, lv_coord_t area_height);
+
+/**
+ * Flush callback that rotates the rendered area and passes it on to the device.
+ *
+ * @param disp_drv display driver
+ * @param area area that was rendered
+ * @param color_p rendered pixels
+ */
+static void rotate_flush_cb(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p);
+
+
+/**
+ * Static variables
+ */
+
+static transpose_fn transpose_impl = transpose_scalar;
+static reverse_fn reverse_impl = reverse_scalar;
+static const char *rotate_impl_name = "scalar";
+
+/* The driver's own flush callback */
+static void (*device_flush_cb)(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p) = NULL;
+
+static lv_disp_rot_t display_rotation = LV_DISP_ROT_NONE;
+/* Physical size of the display */
+static lv_coord_t display_width = 0;
+static lv_coord_t display_height = 0;
+/* Full-screen buffer of a direct mode device */
+static lv_color_t *device_frame = NULL;
+/* Rotated pixels of the flushed area for devices that take areas on their own, grown on demand */
+static lv_color_t *scratch = NULL;
+static size_t scratch_size = 0;
+
+
+/**
+ * Static functions
+ */
+
+static void transpose_block(lv_color_t *dst, ptrdiff_t dst_stride, const lv_color_t *src, ptrdiff_t src_stride,
+    lv_coord_t x1, lv_coord_t x2, lv_coord_t y1, lv_coord_t y2) {
+    for (lv_coord_t y = y1; y < y2; ++y) {
+        for (lv_coord_t x = x1; x < x2; ++x) {
+            dst[x * dst_stride + y] = src[y * src_stride + x];
+        }
+    }
+}
+
+static void transpose_scalar(lv_color_t *dst, ptrdiff_t dst_stride, const lv_color_t *src, ptrdiff_t src_stride,
+    lv_coord_t width, lv_coord_t height) {
+    for (lv_coord_t y0 = 0; y0 < height; y0 += TILE_SIZE) {
+        const lv_coord_t y_end = LV_MIN(y0 + TILE_SIZE, height);
+        for (lv_coord_t x0 = 0; x0 < width; x0 += TILE_SIZE) {
+            transpose_block(dst, dst_stride, src, src_stride, x0, LV_MIN(x0 + TILE_SIZE, width), y0, y_end);
+        }
+    }
+}
+
+static void reverse_scalar(lv_color_t *dst, const lv_color_t *src, lv_coord_t count) {
+    for (lv_coord_t i = 0; i < count; ++i) {
+        dst[i] = src[count - 1 - i];
+    }
+}
+
+#if HAVE_X86_ROTATORS
+__attribute__((target("sse2")))
+static void transpose_sse2(lv_color_t *dst, ptrdiff_t dst_stride, const lv_color_t *src, ptrdiff_t src_stride,
+    lv_coord_t width, lv_coord_t height) {
+    for (lv_coord_t y0 = 0; y0 < height; y0 += TILE_SIZE) {
+        const lv_coord_t y_end = LV_MIN(y0 + TILE_SIZE, height);
+        for (lv_coord_t x0 = 0; x0 < width; x0 += TILE_SIZE) {
+            const lv_coord_t x_end = LV_MIN(x0 + TILE_SIZE, width);
+
+            lv_coord_t y = y0;
+            for (; y + 4 <= y_end; y += 4) {
+                lv_coord_t x = x0;
+                for (; x + 4 <= x_end; x += 4) {
+                    const lv_color_t *in = src + y * src_stride + x;
+                    const __m128i r0 = _mm_loadu_si128((const __m128i *)in);
+                    const __m128i r1 = _mm_loadu_si128((const __m128i *)(in + src_stride));
+                    const __m128i r2 = _mm_loadu_si128((const __m128i *)(in + 2 * src_stride));
+                    const __m128i r3 = _mm_loadu_si128((const __m128i *)(in + 3 * src_stride));
+
+                    /* Interleave pairs of rows, then pairs of pairs */
+                    const __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+                    const __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+                    const __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+                    const __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+
+                    lv_color_t *out = dst + x * dst_stride + y;
+                    _mm_storeu_si128((__m128i *)out, _mm_unpacklo_epi64(t0, t1));
+                    _mm_storeu_si128((__m128i *)(out + dst_stride), _mm_unpackhi_epi64(t0, t1));
+                    _mm_storeu_si128((__m128i *)(out + 2 * dst_stride), _mm_unpacklo_epi64(t2, t3));
+                    _mm_storeu_si128((__m128i *)(out + 3 * dst_stride), _mm_unpackhi_epi64(t2, t3));
+                }
+                transpose_block(dst, dst_stride, src, src_stride, x, x_end, y, y + 4);
+            }
+            transpose_block(dst, dst_stride, src, src_stride, x0, x_end, y, y_end);
+        }
+    }
+}
+
+__attribute__((target("sse2")))
+static void reverse_sse2(lv_color_t *dst, const lv_color_t *src, lv_coord_t count) {
+    lv_coord_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i p = _mm_loadu_si128((const __m128i *)(src + count - 4 - i));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_shuffle_epi32(p, _MM_SHUFFLE(0, 1, 2, 3)));
+    }
+
+    reverse_scalar(dst + i, src, count - i);
+}
+#endif /* HAVE_X86_ROTATORS */
+
+#if HAVE_NEON_ROTATORS
+static void transpose_neon(lv_color_t *dst, ptrdiff_t dst_stride, const lv_color_t *src, ptrdiff_t src_stride,
+    lv_coord_t width, lv_coord_t height) {
+    for (lv_coord_t y0 = 0; y0 < height; y0 += TILE_SIZE) {
+        const lv_coord_t y_end = LV_MIN(y0 + TILE_SIZE, height);
+        for (lv_coord_t x0 = 0; x0 < width; x0 += TILE_SIZE) {
+            const lv_coord_t x_end = LV_MIN(x0 + TILE_SIZE, width);
+
+            lv_coord_t y = y0;
+            for (; y + 4 <= y_end; y += 4) {
+                lv_coord_t x = x0;
+                for (; x + 4 <= x_end; x += 4) {
+                    const uint32_t *in = (const uint32_t *)(src + y * src_stride + x);
+                    const uint32x4_t r0 = vld1q_u32(in);
+                    const uint32x4_t r1 = vld1q_u32(in + src_stride);
+                    const uint32x4_t r2 = vld1q_u32(in + 2 * src_stride);
+                    const uint32x4_t r3 = vld1q_u32(in + 3 * src_stride);
+
+                    /* Transpose 2x2 blocks of pixels, then swap the off-diagonal halves */
+                    const uint32x4x2_t t01 = vtrnq_u32(r0, r1);
+                    const uint32x4x2_t t23 = vtrnq_u32(r2, r3);
+
+                    uint32_t *out = (uint32_t *)(dst + x * dst_stride + y);
+                    vst1q_u32(out, vcombine_u32(vget_low_u32(t01.val[0]), vget_low_u32(t23.val[0])));
+                    vst1q_u32(out + dst_stride, vcombine_u32(vget_low_u32(t01.val[1]), vget_low_u32(t23.val[1])));
+                    vst1q_u32(out + 2 * dst_stride,
+                        vcombine_u32(vget_high_u32(t01.val[0]), vget_high_u32(t23.val[0])));
+                    vst1q_u32(out + 3 * dst_stride,
+                        vcombine_u32(vget_high_u32(t01.val[1]), vget_high_u32(t23.val[1])));
+                }
+                transpose_block(dst, dst_stride, src, src_stride, x, x_end, y, y + 4);
+            }
+            transpose_block(dst, dst_stride, src, src_stride, x0, x_end, y, y_end);
+        }
+    }
+}
+
+static void reverse_neon(lv_color_t *dst, const lv_color_t *src, lv_coord_t count) {
+    lv_coord_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const uint32x4_t p = vrev64q_u32(vld1q_u32((const uint32_t *)(src + count - 4 - i)));
+        vst1q_u32((uint32_t *)(dst + i), vcombine_u32(vget_high_u32(p), vget_low_u32(p)));
+    }
+
+    reverse_scalar(dst + i, src, count - i);
+}
+#endif /* HAVE_NEON_ROTATORS */
+
+static void rotate_area(const lv_area_t *area, lv_area_t *rotated) {
+    switch (display_rotation) {
+    case LV_DISP_ROT_90:
+        rotated->x1 = area->y1;
+        rotated->x2 = area->y2;
+        rotated->y1 = display_height - 1 - area->x2;
+        rotated->y2 = display_height - 1 - area->x1;
+        break;
+    case LV_DISP_ROT_180:
+        rotated->x1 = display_width - 1 - area->x2;
+        rotated->x2 = display_width - 1 - area->x1;
+        rotated->y1 = display_height - 1 - area->y2;
+        rotated->y2 = display_height - 1 - area->y1;
+        break;
+    case LV_DISP_ROT_270:
+        rotated->x1 = display_width - 1 - area->y2;
+        rotated->x2 = display_width - 1 - area->y1;
+        rotated->y1 = area->x1;
+        rotated->y2 = area->x2;
+        break;
+    default:
+        *rotated = *area;
+        break;
+    }
+}
+
+static void rotate_pixels(lv_color_t *dst, ptrdiff_t dst_stride, const lv_color_t *src, ptrdiff_t src_stride,
+    lv_coord_t area_width, lv_coord_t area_height) {
+    switch (display_rotation) {
+    case LV_DISP_ROT_90:
+        /* Columns become rows, the last column at the top */
+        transpose_impl(dst + (area_width - 1) * dst_stride, -dst_stride, src, src_stride, area_width, area_height);
+        break;
+    case LV_DISP_ROT_180:
+        for (lv_coord_t y = 0; y < area_height; ++y) {
+            reverse_impl(dst + (area_height - 1 - y) * dst_stride, src + y * src_stride, area_width);
+        }
+        break;
+    case LV_DISP_ROT_270:
+        /* Columns become rows, the last row on the left */
+        transpose_impl(dst, dst_stride, src + (area_height - 1) * src_stride, -src_stride, area_width, area_height);
+        break;
+    default:
+        for (lv_coord_t y = 0; y < area_height; ++y) {
+            memcpy(dst + y * dst_stride, src + y * src_stride, (size_t)area_width * sizeof(lv_color_t));
+        }
+        break;
+    }
+}
+
+static void rotate_flush_cb(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p) {
+    const lv_coord_t area_width = lv_area_get_width(area);
+    lv_area_t rotated;
+    rotate_area(area, &rotated);
+
+    /* Direct mode devices get the whole screen, others just the area */
+    lv_color_t *device_p = device_frame;
+    lv_color_t *dst = NULL;
+    ptrdiff_t stride = display_width;
+    if (device_frame) {
+        dst = device_frame + rotated.y1 * stride + rotated.x1;
+    } else {
+        const size_t size = (size_t)lv_area_get_size(area);
+        if (size > scratch_size) {
+            lv_color_t *grown = realloc(scratch, size * sizeof(lv_color_t));
+            if (!grown) {
+                ul_log(UL_LOG_LEVEL_ERROR, "Could not allocate %zu pixels for rotating the display", size);
+                lv_disp_flush_ready(disp_drv);
+                return;
+            }
+            scratch = grown;
+            scratch_size = size;
+        }
+        device_p = scratch;
+        stride = lv_area_get_width(&rotated);
+        dst = scratch;
+    }
+
+    rotate_pixels(dst, stride, color_p, area_width, area_width, lv_area_get_height(area));
+
+    /* The device works in physical sizes. The copy shares LVGL's draw buffer state, so the device callback's
+     * lv_disp_flush_ready still reaches LVGL. */
+    lv_disp_drv_t device_drv = *disp_drv;
+    device_drv.hor_res = display_width;
+    device_drv.ver_res = display_height;
+    device_flush_cb(&device_drv, &rotated, device_p);
+}
+
+
+/**
+ * Public functions
+ */
+
+void ul_rotate_init(void) {
+#if HAVE_X86_ROTATORS
+    if (ul_cpu_has_feature(UL_CPU_FEATURE_SSE2)) {
+        transpose_impl = transpose_sse2;
+        reverse_impl = reverse_sse2;
+        rotate_impl_name = "sse2";
+        return;
+    }
+#endif /* HAVE_X86_ROTATORS */
+#if HAVE_NEON_ROTATORS
+    if (ul_cpu_has_feature(UL_CPU_FEATURE_NEON)) {
+        transpose_impl = transpose_neon;
+        reverse_impl = reverse_neon;
+        rotate_impl_name = "neon";
+        return;
+    }
+#endif /* HAVE_NEON_ROTATORS */
+    transpose_impl = transpose_scalar;
+    reverse_impl = reverse_scalar;
+    rotate_impl_name = "scalar";
+}
+
+const char *ul_rotate_get_implementation_name(void) {
+    return rotate_impl_name;
+}
+
+void ul_rotate_start(lv_disp_drv_t *disp_drv, lv_disp_rot_t rotation, lv_coord_t width, lv_coord_t height,
+    lv_color_t *frame) {
+    device_flush_cb = disp_drv->flush_cb;
+    display_rotation = rotation;
+    display_width = width;
+    display_height = height;
+    device_frame = frame;
+
+    disp_drv->flush_cb = rotate_flush_cb;
+    disp_drv->direct_mode = 0;
+}
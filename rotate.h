@@ -0,0 +1,56 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_ROTATE_H
+#define UL_ROTATE_H
+
+#include "lvgl/lvgl.h"
+
+/**
+ * Pick the fastest rotation implementation for the running CPU. Must be called before any other thread is started,
+ * calling it again is harmless.
+ */
+void ul_rotate_init(void);
+
+/**
+ * Get the name of the rotation implementation in use, for logging.
+ *
+ * @return implementation name
+ */
+const char *ul_rotate_get_implementation_name(void);
+
+/**
+ * Rotate everything LVGL renders on its way to the device. LVGL draws the upright screen in chunks and every flushed
+ * chunk is rotated into physical orientation before the device's flush callback sees it, with physical coordinates
+ * and sizes. Replaces the driver's flush callback and turns off direct mode, so it must be called after flush_cb has
+ * been set up and before ul_flush_start. The driver must then be registered with the rotated size.
+ *
+ * @param disp_drv display driver
+ * @param rotation counter-clockwise rotation of the image on the panel, like LVGL's own software rotation
+ * @param width physical width of the display
+ * @param height physical height of the display
+ * @param frame full-screen buffer of width * height pixels that the device's flush callback expects in direct mode,
+ * NULL if the device takes the pixels of each flushed area on its own. Such devices touch more than the flushed area,
+ * so their flushes must not be moved onto ul_flush_start's worker.
+ */
+void ul_rotate_start(lv_disp_drv_t *disp_drv, lv_disp_rot_t rotation, lv_coord_t width, lv_coord_t height,
+    lv_color_t *frame);
+
+#endif /* UL_ROTATE_H */
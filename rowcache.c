@@ -0,0 +1,305 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "rowcache.h"
+
+#include "screen.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * Defines
+ */
+
+/* 64-bit FNV-1a parameters */
+#define HASH_OFFSET 0xcbf29ce484222325ull
+#define HASH_PRIME 0x100000001b3ull
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Find an entry. Must be called with the cache locked.
+ *
+ * @param cache cache to look in
+ * @param key key of the row
+ * @param cells cells of the row
+ * @param length number of cells
+ * @param line_size size of one line of pixels in bytes
+ * @return the entry or NULL if the row is not cached
+ */
+static ul_rowcache_entry *find_entry(ul_rowcache *cache, uint64_t key, const ul_screen_cell *cells, int length,
+    size_t line_size);
+
+/**
+ * Move an entry to the front of the LRU list. Must be called with the cache locked.
+ *
+ * @param cache cache
+ * @param entry entry that was just used
+ */
+static void touch_entry(ul_rowcache *cache, ul_rowcache_entry *entry);
+
+/**
+ * Unlink an entry from the LRU list and its bucket. Must be called with the cache locked.
+ *
+ * @param cache cache
+ * @param entry entry to unlink
+ */
+static void unlink_entry(ul_rowcache *cache, ul_rowcache_entry *entry);
+
+/**
+ * Drop least recently used entries until the cache uses at most a number of bytes. Must be called with the cache
+ * locked.
+ *
+ * @param cache cache
+ * @param max_size number of bytes to shrink to
+ */
+static void evict_to(ul_rowcache *cache, size_t max_size);
+
+/**
+ * Free an entry that is no longer in the cache, unless a copy out of it is still in progress. Must be called with
+ * the cache locked.
+ *
+ * @param entry unlinked entry
+ */
+static void release_entry(ul_rowcache_entry *entry);
+
+
+/**
+ * Static functions
+ */
+
+static ul_rowcache_entry *find_entry(ul_rowcache *cache, uint64_t key, const ul_screen_cell *cells, int length,
+    size_t line_size) {
+    for (ul_rowcache_entry *entry = cache->buckets[key % UL_ROWCACHE_BUCKETS]; entry; entry = entry->chain) {
+        if (entry->key == key && entry->length == length && entry->line_size == line_size
+            && memcmp(entry->cells, cells, (size_t)length * sizeof(ul_screen_cell)) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void touch_entry(ul_rowcache *cache, ul_rowcache_entry *entry) {
+    if (cache->newest == entry) {
+        return;
+    }
+
+    /* Unlink from the LRU list */
+    entry->prev->next = entry->next;
+    if (entry->next) {
+        entry->next->prev = entry->prev;
+    } else {
+        cache->oldest = entry->prev;
+    }
+
+    /* Relink at the front */
+    entry->prev = NULL;
+    entry->next = cache->newest;
+    cache->newest->prev = entry;
+    cache->newest = entry;
+}
+
+static void unlink_entry(ul_rowcache *cache, ul_rowcache_entry *entry) {
+    if (entry->prev) {
+        entry->prev->next = entry->next;
+    } else {
+        cache->newest = entry->next;
+    }
+    if (entry->next) {
+        entry->next->prev = entry->prev;
+    } else {
+        cache->oldest = entry->prev;
+    }
+
+    ul_rowcache_entry **link = &(cache->buckets[entry->key % UL_ROWCACHE_BUCKETS]);
+    while (*link != entry) {
+        link = &((*link)->chain);
+    }
+    *link = entry->chain;
+
+    cache->size -= entry->size;
+}
+
+static void evict_to(ul_rowcache *cache, size_t max_size) {
+    while (cache->oldest && cache->size > max_size) {
+        ul_rowcache_entry *entry = cache->oldest;
+        unlink_entry(cache, entry);
+        release_entry(entry);
+    }
+}
+
+static void release_entry(ul_rowcache_entry *entry) {
+    if (entry->pins > 0) {
+        entry->is_evicted = true;
+        return;
+    }
+    free(entry);
+}
+
+
+/**
+ * Public functions
+ */
+
+void ul_rowcache_init(ul_rowcache *cache, size_t max_size) {
+    memset(cache, 0, sizeof(*cache));
+    cache->max_size = max_size;
+    pthread_mutex_init(&(cache->lock), NULL);
+}
+
+void ul_rowcache_destroy(ul_rowcache *cache) {
+    ul_rowcache_clear(cache);
+    pthread_mutex_destroy(&(cache->lock));
+}
+
+void ul_rowcache_clear(ul_rowcache *cache) {
+    pthread_mutex_lock(&(cache->lock));
+    evict_to(cache, 0);
+    pthread_mutex_unlock(&(cache->lock));
+}
+
+void ul_rowcache_set_max_size(ul_rowcache *cache, size_t max_size) {
+    pthread_mutex_lock(&(cache->lock));
+    cache->max_size = max_size;
+    evict_to(cache, max_size);
+    pthread_mutex_unlock(&(cache->lock));
+}
+
+bool ul_rowcache_is_enabled(const ul_rowcache *cache) {
+    return cache->max_size > 0;
+}
+
+uint64_t ul_rowcache_hash(const ul_screen_cell *cells, int length, uint64_t salt) {
+    uint64_t hash = HASH_OFFSET ^ salt;
+    for (int i = 0; i < length; ++i) {
+        hash = (hash ^ cells[i].codepoint) * HASH_PRIME;
+        hash = (hash ^ cells[i].attr) * HASH_PRIME;
+    }
+    return (hash ^ (uint64_t)length) * HASH_PRIME;
+}
+
+bool ul_rowcache_get(ul_rowcache *cache, uint64_t key, const ul_screen_cell *cells, int length,
+    size_t line_size, int first_line, int last_line, void *dst, size_t dst_stride) {
+    pthread_mutex_lock(&(cache->lock));
+
+    ul_rowcache_entry *entry = find_entry(cache, key, cells, length, line_size);
+    if (!entry || first_line < 0 || last_line >= entry->lines) {
+        cache->misses++;
+        pthread_mutex_unlock(&(cache->lock));
+        return false;
+    }
+
+    cache->hits++;
+    touch_entry(cache, entry);
+
+    /* Pin the entry so that it outlives an eviction while the pixels are copied without the lock */
+    entry->pins++;
+    pthread_mutex_unlock(&(cache->lock));
+
+    const uint8_t *src = entry->pixels + (size_t)first_line * line_size;
+    uint8_t *out = dst;
+    for (int line = first_line; line <= last_line; ++line) {
+        memcpy(out, src, line_size);
+        src += line_size;
+        out += dst_stride;
+    }
+
+    pthread_mutex_lock(&(cache->lock));
+    entry->pins--;
+    if (entry->is_evicted) {
+        release_entry(entry);
+    }
+    pthread_mutex_unlock(&(cache->lock));
+    return true;
+}
+
+void ul_rowcache_put(ul_rowcache *cache, uint64_t key, const ul_screen_cell *cells, int length,
+    size_t line_size, int lines, const void *src, size_t src_stride) {
+    const size_t cells_size = (size_t)length * sizeof(ul_screen_cell);
+    const size_t size = sizeof(ul_rowcache_entry) + cells_size + line_size * (size_t)lines;
+
+    /* Rows larger than the whole cache are not worth evicting everything for */
+    pthread_mutex_lock(&(cache->lock));
+    bool is_wanted = size <= cache->max_size && !find_entry(cache, key, cells, length, line_size);
+    pthread_mutex_unlock(&(cache->lock));
+    if (!is_wanted) {
+        return;
+    }
+
+    /* Cells and pixels share one allocation with the entry, which is filled before taking the lock */
+    ul_rowcache_entry *entry = malloc(size);
+    if (!entry) {
+        return;
+    }
+
+    entry->key = key;
+    entry->cells = (ul_screen_cell *)(entry + 1);
+    entry->length = length;
+    entry->pixels = (uint8_t *)entry->cells + cells_size;
+    entry->line_size = line_size;
+    entry->lines = lines;
+    entry->size = size;
+    entry->pins = 0;
+    entry->is_evicted = false;
+    memcpy(entry->cells, cells, cells_size);
+
+    const uint8_t *in = src;
+    for (int line = 0; line < lines; ++line) {
+        memcpy(entry->pixels + (size_t)line * line_size, in, line_size);
+        in += src_stride;
+    }
+
+    /* Another thread may have stored the same row or shrunk the cache in the meantime */
+    pthread_mutex_lock(&(cache->lock));
+    if (size > cache->max_size || find_entry(cache, key, cells, length, line_size)) {
+        pthread_mutex_unlock(&(cache->lock));
+        free(entry);
+        return;
+    }
+    evict_to(cache, cache->max_size - size);
+
+    ul_rowcache_entry **bucket = &(cache->buckets[key % UL_ROWCACHE_BUCKETS]);
+    entry->chain = *bucket;
+    *bucket = entry;
+
+    entry->prev = NULL;
+    entry->next = cache->newest;
+    if (cache->newest) {
+        cache->newest->prev = entry;
+    } else {
+        cache->oldest = entry;
+    }
+    cache->newest = entry;
+    cache->size += size;
+
+    pthread_mutex_unlock(&(cache->lock));
+}
+
+void ul_rowcache_get_stats(ul_rowcache *cache, uint64_t *hits, uint64_t *misses) {
+    pthread_mutex_lock(&(cache->lock));
+    *hits = cache->hits;
+    *misses = cache->misses;
+    pthread_mutex_unlock(&(cache->lock));
+}
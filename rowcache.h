@@ -0,0 +1,165 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_ROWCACHE_H
+#define UL_ROWCACHE_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Cells are defined by the screen, forward declared to avoid a circular include */
+struct ul_screen_cell_t;
+
+/* Number of hash buckets */
+#define UL_ROWCACHE_BUCKETS 1024
+
+/* One cached row */
+typedef struct ul_rowcache_entry_t {
+    /* Neighbours in the LRU list, most recently used first */
+    struct ul_rowcache_entry_t *prev;
+    struct ul_rowcache_entry_t *next;
+    /* Next entry in the same bucket */
+    struct ul_rowcache_entry_t *chain;
+    uint64_t key;
+    /* Copy of the cells the pixels were drawn from, compared on lookup so that hash collisions do no harm */
+    struct ul_screen_cell_t *cells;
+    int length;
+    /* Pixels, lines of line_size bytes back to back */
+    uint8_t *pixels;
+    size_t line_size;
+    int lines;
+    /* Bytes accounted for the entry */
+    size_t size;
+    /* Number of copies out of the entry that are in progress without the lock held */
+    int pins;
+    /* Evicted while pinned, freed by the last copy that finishes */
+    bool is_evicted;
+} ul_rowcache_entry;
+
+/**
+ * Least recently used cache of rendered rows, keyed by a hash of the row's cells and everything else that affects
+ * how they are drawn. All functions may be called from any thread. The lock only covers lookups and the LRU list,
+ * pixels are copied in and out without holding it.
+ */
+typedef struct {
+    ul_rowcache_entry *buckets[UL_ROWCACHE_BUCKETS];
+    ul_rowcache_entry *newest;
+    ul_rowcache_entry *oldest;
+    /* Memory used by the entries and the cap it is kept under, 0 disables the cache */
+    size_t size;
+    size_t max_size;
+    /* Lookup statistics */
+    uint64_t hits;
+    uint64_t misses;
+    pthread_mutex_t lock;
+} ul_rowcache;
+
+/**
+ * Initialise an empty cache.
+ *
+ * @param cache cache to initialise
+ * @param max_size maximum number of bytes to use, 0 to disable the cache
+ */
+void ul_rowcache_init(ul_rowcache *cache, size_t max_size);
+
+/**
+ * Release all entries of a cache.
+ *
+ * @param cache cache to destroy
+ */
+void ul_rowcache_destroy(ul_rowcache *cache);
+
+/**
+ * Remove all entries, e.g. after the font changed. The statistics are kept.
+ *
+ * @param cache cache to clear
+ */
+void ul_rowcache_clear(ul_rowcache *cache);
+
+/**
+ * Change the memory cap, evicting entries if needed.
+ *
+ * @param cache cache to resize
+ * @param max_size maximum number of bytes to use, 0 to disable the cache
+ */
+void ul_rowcache_set_max_size(ul_rowcache *cache, size_t max_size);
+
+/**
+ * Check whether the cache stores anything at all.
+ *
+ * @param cache cache to query
+ * @return true if the cache has a non-zero memory cap
+ */
+bool ul_rowcache_is_enabled(const ul_rowcache *cache);
+
+/**
+ * Compute the key of a row.
+ *
+ * @param cells cells of the row
+ * @param length number of cells
+ * @param salt hash of everything besides the cells that affects the pixels, e.g. the row width and colours
+ * @return the key
+ */
+uint64_t ul_rowcache_hash(const struct ul_screen_cell_t *cells, int length, uint64_t salt);
+
+/**
+ * Copy lines of a cached row out of the cache.
+ *
+ * @param cache cache to look in
+ * @param key key of the row
+ * @param cells cells of the row
+ * @param length number of cells
+ * @param line_size size of one line of pixels in bytes
+ * @param first_line first line to copy
+ * @param last_line last line to copy (inclusive)
+ * @param dst where to copy the first line to
+ * @param dst_stride distance between consecutive lines at dst in bytes
+ * @return true on a hit, false if the row is not cached
+ */
+bool ul_rowcache_get(ul_rowcache *cache, uint64_t key, const struct ul_screen_cell_t *cells, int length,
+    size_t line_size, int first_line, int last_line, void *dst, size_t dst_stride);
+
+/**
+ * Store a rendered row, evicting the least recently used rows if the cache is full.
+ *
+ * @param cache cache to store in
+ * @param key key of the row
+ * @param cells cells of the row
+ * @param length number of cells
+ * @param line_size size of one line of pixels in bytes
+ * @param lines number of lines
+ * @param src first line of pixels
+ * @param src_stride distance between consecutive lines at src in bytes
+ */
+void ul_rowcache_put(ul_rowcache *cache, uint64_t key, const struct ul_screen_cell_t *cells, int length,
+    size_t line_size, int lines, const void *src, size_t src_stride);
+
+/**
+ * Get the lookup statistics.
+ *
+ * @param cache cache to query
+ * @param hits pointer for writing the number of lookups that found the row
+ * @param misses pointer for writing the number of lookups that did not
+ */
+void ul_rowcache_get_stats(ul_rowcache *cache, uint64_t *hits, uint64_t *misses);
+
+#endif /* UL_ROWCACHE_H */
@@ -0,0 +1,235 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "scan.h"
+
+#include "cpu.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_SCANNERS 1
+#endif
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#define HAVE_NEON_SCANNER 1
+#endif
+
+
+/**
+ * Defines
+ */
+
+/* Bit tricks for finding bytes in a 64 bit word, see https://graphics.stanford.edu/~seander/bithacks.html */
+#define ONES (~(uint64_t)0 / 255)
+#define HIGH_BITS (ONES * 0x80)
+/* Bytes less than n (n <= 128) */
+#define HAS_LESS(x, n) (((x) - ONES * (n)) & ~(x) & HIGH_BITS)
+/* Bytes greater than n (n <= 127) */
+#define HAS_MORE(x, n) ((((x) + ONES * (127 - (n))) | (x)) & HIGH_BITS)
+
+/* Scanner signature */
+typedef const uint8_t *(*scan_fn)(const uint8_t *p, const uint8_t *end);
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Check whether a byte is printable ASCII.
+ *
+ * @param byte byte to check
+ * @return true if the byte lies in 0x20 - 0x7e
+ */
+static inline bool is_printable(uint8_t byte);
+
+/**
+ * Portable scanner working on eight bytes at a time.
+ *
+ * @param p start of the bytes to scan
+ * @param end end of the bytes to scan
+ * @return pointer to the first non-printable byte or end
+ */
+static const uint8_t *scan_scalar(const uint8_t *p, const uint8_t *end);
+
+#if HAVE_X86_SCANNERS
+/**
+ * SSE2 scanner working on 16 bytes at a time.
+ *
+ * @param p start of the bytes to scan
+ * @param end end of the bytes to scan
+ * @return pointer to the first non-printable byte or end
+ */
+static const uint8_t *scan_sse2(const uint8_t *p, const uint8_t *end);
+
+/**
+ * AVX2 scanner working on 32 bytes at a time.
+ *
+ * @param p start of the bytes to scan
+ * @param end end of the bytes to scan
+ * @return pointer to the first non-printable byte or end
+ */
+static const uint8_t *scan_avx2(const uint8_t *p, const uint8_t *end);
+#endif /* HAVE_X86_SCANNERS */
+
+#if HAVE_NEON_SCANNER
+/**
+ * NEON scanner working on 16 bytes at a time.
+ *
+ * @param p start of the bytes to scan
+ * @param end end of the bytes to scan
+ * @return pointer to the first non-printable byte or end
+ */
+static const uint8_t *scan_neon(const uint8_t *p, const uint8_t *end);
+#endif /* HAVE_NEON_SCANNER */
+
+
+/**
+ * Static variables
+ */
+
+static scan_fn scan_impl = scan_scalar;
+static const char *scan_impl_name = "scalar";
+
+
+/**
+ * Static functions
+ */
+
+static inline bool is_printable(uint8_t byte) {
+    return byte >= 0x20 && byte < 0x7f;
+}
+
+static const uint8_t *scan_scalar(const uint8_t *p, const uint8_t *end) {
+    while (end - p >= 8) {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+        if (HAS_LESS(word, 0x20) | HAS_MORE(word, 0x7e)) {
+            break;
+        }
+        p += 8;
+    }
+
+    while (p < end && is_printable(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+#if HAVE_X86_SCANNERS
+__attribute__((target("sse2")))
+static const uint8_t *scan_sse2(const uint8_t *p, const uint8_t *end) {
+    /* Signed compares: bytes >= 0x80 are negative and fail the lower bound */
+    const __m128i lower = _mm_set1_epi8(0x1f);
+    const __m128i upper = _mm_set1_epi8(0x7f);
+
+    while (end - p >= 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *)p);
+        __m128i printable = _mm_and_si128(_mm_cmpgt_epi8(bytes, lower), _mm_cmplt_epi8(bytes, upper));
+        unsigned int mask = ~(unsigned int)_mm_movemask_epi8(printable) & 0xffff;
+        if (mask) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+
+    return scan_scalar(p, end);
+}
+
+__attribute__((target("avx2")))
+static const uint8_t *scan_avx2(const uint8_t *p, const uint8_t *end) {
+    const __m256i lower = _mm256_set1_epi8(0x1f);
+    const __m256i upper = _mm256_set1_epi8(0x7f);
+
+    while (end - p >= 32) {
+        __m256i bytes = _mm256_loadu_si256((const __m256i *)p);
+        __m256i printable = _mm256_and_si256(_mm256_cmpgt_epi8(bytes, lower), _mm256_cmpgt_epi8(upper, bytes));
+        unsigned int mask = ~(unsigned int)_mm256_movemask_epi8(printable);
+        if (mask) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
+    }
+
+    return scan_sse2(p, end);
+}
+#endif /* HAVE_X86_SCANNERS */
+
+#if HAVE_NEON_SCANNER
+static const uint8_t *scan_neon(const uint8_t *p, const uint8_t *end) {
+    const uint8x16_t lower = vdupq_n_u8(0x20);
+    const uint8x16_t upper = vdupq_n_u8(0x7e);
+
+    while (end - p >= 16) {
+        uint8x16_t bytes = vld1q_u8(p);
+        uint8x16_t printable = vandq_u8(vcgeq_u8(bytes, lower), vcleq_u8(bytes, upper));
+        /* Narrow the byte mask to four bits per byte so that it fits into one 64 bit lane */
+        uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(vmvnq_u8(printable)), 4);
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(nibbles), 0);
+        if (mask) {
+            return p + (__builtin_ctzll(mask) >> 2);
+        }
+        p += 16;
+    }
+
+    return scan_scalar(p, end);
+}
+#endif /* HAVE_NEON_SCANNER */
+
+
+/**
+ * Public functions
+ */
+
+void ul_scan_init(void) {
+#if HAVE_X86_SCANNERS
+    if (ul_cpu_has_feature(UL_CPU_FEATURE_AVX2)) {
+        scan_impl = scan_avx2;
+        scan_impl_name = "avx2";
+        return;
+    }
+    if (ul_cpu_has_feature(UL_CPU_FEATURE_SSE2)) {
+        scan_impl = scan_sse2;
+        scan_impl_name = "sse2";
+        return;
+    }
+#endif /* HAVE_X86_SCANNERS */
+#if HAVE_NEON_SCANNER
+    if (ul_cpu_has_feature(UL_CPU_FEATURE_NEON)) {
+        scan_impl = scan_neon;
+        scan_impl_name = "neon";
+        return;
+    }
+#endif /* HAVE_NEON_SCANNER */
+    scan_impl = scan_scalar;
+    scan_impl_name = "scalar";
+}
+
+const char *ul_scan_get_implementation_name(void) {
+    return scan_impl_name;
+}
+
+const uint8_t *ul_scan_printable(const uint8_t *p, const uint8_t *end) {
+    return scan_impl(p, end);
+}
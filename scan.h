@@ -0,0 +1,48 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_SCAN_H
+#define UL_SCAN_H
+
+#include <stdint.h>
+
+/**
+ * Pick the fastest scanner implementation for the running CPU. Must be called before any other thread is
+ * started, calling it again is harmless.
+ */
+void ul_scan_init(void);
+
+/**
+ * Get the name of the scanner implementation in use, for logging.
+ *
+ * @return implementation name
+ */
+const char *ul_scan_get_implementation_name(void);
+
+/**
+ * Skip printable ASCII characters (0x20 - 0x7e).
+ *
+ * @param p start of the bytes to scan
+ * @param end end of the bytes to scan
+ * @return pointer to the first control, DEL or non-ASCII byte, or end if there is none
+ */
+const uint8_t *ul_scan_printable(const uint8_t *p, const uint8_t *end);
+
+#endif /* UL_SCAN_H */
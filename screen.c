@@ -0,0 +1,994 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "screen.h"
+
+#include "scan.h"
+#include "utf8.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * Defines
+ */
+
+#define TAB_WIDTH 8
+/* Average number of cells per scrollback line to reserve. Trailing blanks are not stored, so most shell output
+ * takes far less than a full row. */
+#define SCROLLBACK_CELLS_PER_LINE 48
+/* Bytes of non-ASCII text decoded at once */
+#define DECODE_CHUNK_SIZE 256
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Get a pointer to a cell of the active grid.
+ *
+ * @param screen screen
+ * @param row row index
+ * @param col column index
+ * @return the cell
+ */
+static ul_screen_cell *cell_at(ul_screen *screen, int row, int col);
+
+/**
+ * Get the cell used for erasing, which keeps the current background colour.
+ *
+ * @param screen screen
+ * @return blank cell
+ */
+static ul_screen_cell blank_cell(const ul_screen *screen);
+
+/**
+ * Fill a range of cells within one row with blanks.
+ *
+ * @param screen screen
+ * @param row row index
+ * @param first first column
+ * @param last last column (exclusive)
+ */
+static void erase_cells(ul_screen *screen, int row, int first, int last);
+
+/**
+ * Fill a range of rows with blanks.
+ *
+ * @param screen screen
+ * @param first first row
+ * @param last last row (exclusive)
+ */
+static void erase_rows(ul_screen *screen, int first, int last);
+
+/**
+ * Mark a range of rows as changed.
+ *
+ * @param screen screen
+ * @param first first row
+ * @param last last row (exclusive)
+ */
+static void mark_rows_dirty(ul_screen *screen, int first, int last);
+
+/**
+ * Set or clear the dirty bit of a row.
+ *
+ * @param screen screen
+ * @param row row index
+ * @param is_dirty true if the row needs to be redrawn
+ */
+static void set_row_dirty(ul_screen *screen, int row, bool is_dirty);
+
+/**
+ * Record that the rows of a region moved, carrying their dirty bits along and marking the rows that became free.
+ *
+ * @param screen screen
+ * @param top first row of the region
+ * @param bottom last row of the region (inclusive)
+ * @param lines number of rows the region moved up by (negative for down)
+ */
+static void track_move(ul_screen *screen, int top, int bottom, int lines);
+
+/**
+ * Move the rows of a region up, blanking the rows that become free at the bottom.
+ *
+ * @param screen screen
+ * @param top first row of the region
+ * @param bottom last row of the region (inclusive)
+ * @param count number of rows to scroll by
+ */
+static void scroll_up(ul_screen *screen, int top, int bottom, int count);
+
+/**
+ * Move the rows of a region down, blanking the rows that become free at the top.
+ *
+ * @param screen screen
+ * @param top first row of the region
+ * @param bottom last row of the region (inclusive)
+ * @param count number of rows to scroll by
+ */
+static void scroll_down(ul_screen *screen, int top, int bottom, int count);
+
+/**
+ * Move the cursor, clamping it to the screen.
+ *
+ * @param screen screen
+ * @param row new row
+ * @param col new column
+ */
+static void move_cursor(ul_screen *screen, int row, int col);
+
+/**
+ * Move the cursor down one row, scrolling the region if it is on the bottom margin (IND / LF).
+ *
+ * @param screen screen
+ */
+static void line_feed(ul_screen *screen);
+
+/**
+ * Move the cursor up one row, scrolling the region if it is on the top margin (RI).
+ *
+ * @param screen screen
+ */
+static void reverse_line_feed(ul_screen *screen);
+
+/**
+ * Write a single character at the cursor and advance it.
+ *
+ * @param screen screen
+ * @param codepoint character to write
+ */
+static void put_char(ul_screen *screen, uint32_t codepoint);
+
+/**
+ * Write a run of printable ASCII characters, filling whole stretches of a row at once.
+ *
+ * @param screen screen
+ * @param data characters in the range 0x20 - 0x7e
+ * @param length number of characters
+ */
+static void put_ascii_run(ul_screen *screen, const uint8_t *data, size_t length);
+
+/**
+ * Write a run of printable UTF-8 text.
+ *
+ * @param screen screen
+ * @param data UTF-8 bytes, sequences may continue in the next run
+ * @param length number of bytes
+ */
+static void print(ul_screen *screen, const char *data, size_t length);
+
+/**
+ * Handle a C0 control character.
+ *
+ * @param screen screen
+ * @param byte control character
+ */
+static void execute(ul_screen *screen, uint8_t byte);
+
+/**
+ * Handle an escape sequence.
+ *
+ * @param screen screen
+ * @param action parsed sequence
+ */
+static void esc_dispatch(ul_screen *screen, const ul_vt_action *action);
+
+/**
+ * Handle a control sequence.
+ *
+ * @param screen screen
+ * @param action parsed sequence
+ */
+static void csi_dispatch(ul_screen *screen, const ul_vt_action *action);
+
+/**
+ * Handle SGR (select graphic rendition).
+ *
+ * @param screen screen
+ * @param action parsed sequence
+ */
+static void select_graphic_rendition(ul_screen *screen, const ul_vt_action *action);
+
+/**
+ * Handle DECSET / DECRST.
+ *
+ * @param screen screen
+ * @param action parsed sequence
+ * @param enable true for DECSET, false for DECRST
+ */
+static void set_private_mode(ul_screen *screen, const ul_vt_action *action, bool enable);
+
+/**
+ * Switch between the primary and the alternate grid.
+ *
+ * @param screen screen
+ * @param alternate true to switch to the alternate grid
+ */
+static void use_alternate_grid(ul_screen *screen, bool alternate);
+
+/**
+ * Save the cursor position and attributes.
+ *
+ * @param screen screen
+ */
+static void save_cursor(ul_screen *screen);
+
+/**
+ * Restore the saved cursor position and attributes.
+ *
+ * @param screen screen
+ */
+static void restore_cursor(ul_screen *screen);
+
+/**
+ * Return the screen to its initial state (RIS).
+ *
+ * @param screen screen
+ */
+static void reset(ul_screen *screen);
+
+/**
+ * Get a numeric parameter of a sequence, substituting a default for omitted or zero values.
+ *
+ * @param action parsed sequence
+ * @param index parameter index
+ * @param fallback value used if the parameter is omitted or zero
+ * @return parameter value
+ */
+static int param(const ul_vt_action *action, int index, int fallback);
+
+/**
+ * Map a 24 bit colour onto the closest entry of the 6x6x6 colour cube.
+ *
+ * @param r red
+ * @param g green
+ * @param b blue
+ * @return palette index
+ */
+static uint8_t rgb_to_palette(int r, int g, int b);
+
+
+/**
+ * Static functions
+ */
+
+static ul_screen_cell *cell_at(ul_screen *screen, int row, int col) {
+    return &(screen->cells[(size_t)row * screen->cols + col]);
+}
+
+static ul_screen_cell blank_cell(const ul_screen *screen) {
+    ul_screen_cell cell = {
+        .codepoint = ' ',
+        .attr = (screen->attr & (0xff00 | UL_SCREEN_ATTR_DEFAULT_BG)) | UL_SCREEN_ATTR_DEFAULT_FG
+    };
+    return cell;
+}
+
+static void erase_cells(ul_screen *screen, int row, int first, int last) {
+    if (first < 0) {
+        first = 0;
+    }
+    if (last > screen->cols) {
+        last = screen->cols;
+    }
+    if (first >= last) {
+        return;
+    }
+
+    ul_screen_cell blank = blank_cell(screen);
+    ul_screen_cell *cells = cell_at(screen, row, 0);
+    for (int col = first; col < last; ++col) {
+        cells[col] = blank;
+    }
+    ul_screen_mark_row_dirty(screen, row);
+}
+
+static void erase_rows(ul_screen *screen, int first, int last) {
+    for (int row = first; row < last; ++row) {
+        erase_cells(screen, row, 0, screen->cols);
+    }
+}
+
+static void mark_rows_dirty(ul_screen *screen, int first, int last) {
+    for (int row = first; row < last; ++row) {
+        ul_screen_mark_row_dirty(screen, row);
+    }
+}
+
+static void set_row_dirty(ul_screen *screen, int row, bool is_dirty) {
+    const uint64_t bit = (uint64_t)1 << (row % 64);
+    if (is_dirty) {
+        screen->dirty[row / 64] |= bit;
+    } else {
+        screen->dirty[row / 64] &= ~bit;
+    }
+}
+
+static void track_move(ul_screen *screen, int top, int bottom, int lines) {
+    if (screen->is_region_moved && (screen->moved_top != top || screen->moved_bottom != bottom)) {
+        /* Only one region is tracked, the previous one has to be redrawn in full */
+        mark_rows_dirty(screen, screen->moved_top, screen->moved_bottom + 1);
+        screen->moved_lines = 0;
+    }
+
+    /* Dirty bits follow their rows, rows that were scrolled in are dirty */
+    const int height = bottom - top + 1;
+    if (lines > 0) {
+        for (int row = top; row <= bottom - lines; ++row) {
+            set_row_dirty(screen, row, ul_screen_is_row_dirty(screen, row + lines));
+        }
+        mark_rows_dirty(screen, bottom - lines + 1, bottom + 1);
+    } else {
+        for (int row = bottom; row >= top - lines; --row) {
+            set_row_dirty(screen, row, ul_screen_is_row_dirty(screen, row + lines));
+        }
+        mark_rows_dirty(screen, top, top - lines);
+    }
+
+    screen->is_region_moved = true;
+    screen->moved_top = top;
+    screen->moved_bottom = bottom;
+    screen->moved_lines += lines;
+    if (screen->moved_lines >= height || screen->moved_lines <= -height) {
+        /* Nothing that was on screen is left in the region */
+        mark_rows_dirty(screen, top, bottom + 1);
+        screen->moved_lines = 0;
+    }
+}
+
+static void scroll_up(ul_screen *screen, int top, int bottom, int count) {
+    int height = bottom - top + 1;
+    if (count > height) {
+        count = height;
+    }
+    if (count <= 0) {
+        return;
+    }
+
+    /* Keep the lines leaving the top of the primary grid */
+    if (top == 0 && !screen->is_alternate) {
+        for (int row = 0; row < count; ++row) {
+            ul_scrollback_push(&(screen->scrollback), cell_at(screen, row, 0), screen->cols);
+        }
+    }
+
+    memmove(cell_at(screen, top, 0), cell_at(screen, top + count, 0),
+        (size_t)(height - count) * screen->cols * sizeof(ul_screen_cell));
+    track_move(screen, top, bottom, count);
+    erase_rows(screen, bottom - count + 1, bottom + 1);
+}
+
+static void scroll_down(ul_screen *screen, int top, int bottom, int count) {
+    int height = bottom - top + 1;
+    if (count > height) {
+        count = height;
+    }
+    if (count <= 0) {
+        return;
+    }
+
+    memmove(cell_at(screen, top + count, 0), cell_at(screen, top, 0),
+        (size_t)(height - count) * screen->cols * sizeof(ul_screen_cell));
+    track_move(screen, top, bottom, -count);
+    erase_rows(screen, top, top + count);
+}
+
+static void move_cursor(ul_screen *screen, int row, int col) {
+    if (row < 0) {
+        row = 0;
+    } else if (row >= screen->rows) {
+        row = screen->rows - 1;
+    }
+    if (col < 0) {
+        col = 0;
+    } else if (col >= screen->cols) {
+        col = screen->cols - 1;
+    }
+
+    screen->cursor_row = row;
+    screen->cursor_col = col;
+    screen->is_wrap_pending = false;
+}
+
+static void line_feed(ul_screen *screen) {
+    if (screen->cursor_row == screen->scroll_bottom) {
+        scroll_up(screen, screen->scroll_top, screen->scroll_bottom, 1);
+    } else if (screen->cursor_row < screen->rows - 1) {
+        screen->cursor_row++;
+    }
+    screen->is_wrap_pending = false;
+}
+
+static void reverse_line_feed(ul_screen *screen) {
+    if (screen->cursor_row == screen->scroll_top) {
+        scroll_down(screen, screen->scroll_top, screen->scroll_bottom, 1);
+    } else if (screen->cursor_row > 0) {
+        screen->cursor_row--;
+    }
+    screen->is_wrap_pending = false;
+}
+
+static void put_char(ul_screen *screen, uint32_t codepoint) {
+    if (screen->is_wrap_pending) {
+        screen->cursor_col = 0;
+        line_feed(screen);
+    }
+
+    ul_screen_cell *cell = cell_at(screen, screen->cursor_row, screen->cursor_col);
+    cell->codepoint = codepoint;
+    cell->attr = screen->attr;
+    ul_screen_mark_row_dirty(screen, screen->cursor_row);
+
+    if (screen->cursor_col < screen->cols - 1) {
+        screen->cursor_col++;
+    } else if (screen->is_auto_wrap) {
+        screen->is_wrap_pending = true;
+    }
+}
+
+static void put_ascii_run(ul_screen *screen, const uint8_t *data, size_t length) {
+    while (length > 0) {
+        /* The last column and pending wraps go through put_char */
+        int room = screen->cols - 1 - screen->cursor_col;
+        if (screen->is_wrap_pending || room <= 0) {
+            put_char(screen, *data);
+            ++data;
+            --length;
+            continue;
+        }
+
+        size_t count = length < (size_t)room ? length : (size_t)room;
+        ul_screen_cell *cell = cell_at(screen, screen->cursor_row, screen->cursor_col);
+        for (size_t i = 0; i < count; ++i) {
+            cell[i].codepoint = data[i];
+            cell[i].attr = screen->attr;
+        }
+        ul_screen_mark_row_dirty(screen, screen->cursor_row);
+        screen->cursor_col += count;
+        data += count;
+        length -= count;
+    }
+}
+
+static void print(ul_screen *screen, const char *data, size_t length) {
+    const uint8_t *p = (const uint8_t *)data;
+    const uint8_t *end = p + length;
+    uint32_t codepoints[DECODE_CHUNK_SIZE + 1];
+
+    while (p < end) {
+        if (ul_utf8_decoder_is_idle(&(screen->utf8))) {
+            const uint8_t *run_end = ul_scan_printable(p, end);
+            if (run_end > p) {
+                put_ascii_run(screen, p, run_end - p);
+                p = run_end;
+                continue;
+            }
+        }
+
+        size_t chunk = end - p < DECODE_CHUNK_SIZE ? (size_t)(end - p) : DECODE_CHUNK_SIZE;
+        size_t count = ul_utf8_decode(&(screen->utf8), p, chunk, codepoints);
+        for (size_t i = 0; i < count; ++i) {
+            put_char(screen, codepoints[i]);
+        }
+        p += chunk;
+    }
+}
+
+static void execute(ul_screen *screen, uint8_t byte) {
+    switch (byte) {
+    case '\b':
+        if (screen->cursor_col > 0) {
+            screen->cursor_col--;
+        }
+        screen->is_wrap_pending = false;
+        break;
+    case '\t': {
+        int col = (screen->cursor_col / TAB_WIDTH + 1) * TAB_WIDTH;
+        screen->cursor_col = col < screen->cols ? col : screen->cols - 1;
+        screen->is_wrap_pending = false;
+        break;
+    }
+    case '\n':
+    case '\v':
+    case '\f':
+        line_feed(screen);
+        break;
+    case '\r':
+        screen->cursor_col = 0;
+        screen->is_wrap_pending = false;
+        break;
+    default:
+        break;
+    }
+}
+
+static void esc_dispatch(ul_screen *screen, const ul_vt_action *action) {
+    if (action->num_intermediates > 0) {
+        /* Character set designations and the like are not supported */
+        return;
+    }
+
+    switch (action->byte) {
+    case '7':
+        save_cursor(screen);
+        break;
+    case '8':
+        restore_cursor(screen);
+        break;
+    case 'D':
+        line_feed(screen);
+        break;
+    case 'E':
+        screen->cursor_col = 0;
+        line_feed(screen);
+        break;
+    case 'M':
+        reverse_line_feed(screen);
+        break;
+    case 'c':
+        reset(screen);
+        break;
+    default:
+        break;
+    }
+}
+
+static void csi_dispatch(ul_screen *screen, const ul_vt_action *action) {
+    if (action->num_intermediates > 0) {
+        return;
+    }
+
+    if (action->prefix == '?') {
+        if (action->byte == 'h' || action->byte == 'l') {
+            set_private_mode(screen, action, action->byte == 'h');
+        }
+        return;
+    } else if (action->prefix != 0) {
+        return;
+    }
+
+    int row = screen->cursor_row;
+    int col = screen->cursor_col;
+
+    switch (action->byte) {
+    case '@': { /* ICH */
+        int count = param(action, 0, 1);
+        if (count > screen->cols - col) {
+            count = screen->cols - col;
+        }
+        ul_screen_cell *cells = cell_at(screen, row, 0);
+        memmove(&(cells[col + count]), &(cells[col]), (size_t)(screen->cols - col - count) * sizeof(ul_screen_cell));
+        erase_cells(screen, row, col, col + count);
+        screen->is_wrap_pending = false;
+        break;
+    }
+    case 'A': /* CUU */
+        move_cursor(screen, row - param(action, 0, 1), col);
+        break;
+    case 'B': /* CUD */
+    case 'e': /* VPR */
+        move_cursor(screen, row + param(action, 0, 1), col);
+        break;
+    case 'C': /* CUF */
+    case 'a': /* HPR */
+        move_cursor(screen, row, col + param(action, 0, 1));
+        break;
+    case 'D': /* CUB */
+        move_cursor(screen, row, col - param(action, 0, 1));
+        break;
+    case 'E': /* CNL */
+        move_cursor(screen, row + param(action, 0, 1), 0);
+        break;
+    case 'F': /* CPL */
+        move_cursor(screen, row - param(action, 0, 1), 0);
+        break;
+    case 'G': /* CHA */
+    case '`': /* HPA */
+        move_cursor(screen, row, param(action, 0, 1) - 1);
+        break;
+    case 'H': /* CUP */
+    case 'f': /* HVP */
+        move_cursor(screen, param(action, 0, 1) - 1, param(action, 1, 1) - 1);
+        break;
+    case 'J': /* ED */
+        switch (action->num_params > 0 ? action->params[0] : 0) {
+        case 0:
+            erase_cells(screen, row, col, screen->cols);
+            erase_rows(screen, row + 1, screen->rows);
+            break;
+        case 1:
+            erase_rows(screen, 0, row);
+            erase_cells(screen, row, 0, col + 1);
+            break;
+        case 2:
+            erase_rows(screen, 0, screen->rows);
+            break;
+        case 3:
+            ul_scrollback_clear(&(screen->scrollback));
+            break;
+        }
+        break;
+    case 'K': /* EL */
+        switch (action->num_params > 0 ? action->params[0] : 0) {
+        case 0:
+            erase_cells(screen, row, col, screen->cols);
+            break;
+        case 1:
+            erase_cells(screen, row, 0, col + 1);
+            break;
+        case 2:
+            erase_cells(screen, row, 0, screen->cols);
+            break;
+        }
+        break;
+    case 'L': /* IL */
+        if (row >= screen->scroll_top && row <= screen->scroll_bottom) {
+            scroll_down(screen, row, screen->scroll_bottom, param(action, 0, 1));
+            screen->cursor_col = 0;
+            screen->is_wrap_pending = false;
+        }
+        break;
+    case 'M': /* DL */
+        if (row >= screen->scroll_top && row <= screen->scroll_bottom) {
+            scroll_up(screen, row, screen->scroll_bottom, param(action, 0, 1));
+            screen->cursor_col = 0;
+            screen->is_wrap_pending = false;
+        }
+        break;
+    case 'P': { /* DCH */
+        int count = param(action, 0, 1);
+        if (count > screen->cols - col) {
+            count = screen->cols - col;
+        }
+        ul_screen_cell *cells = cell_at(screen, row, 0);
+        memmove(&(cells[col]), &(cells[col + count]), (size_t)(screen->cols - col - count) * sizeof(ul_screen_cell));
+        erase_cells(screen, row, screen->cols - count, screen->cols);
+        screen->is_wrap_pending = false;
+        break;
+    }
+    case 'S': /* SU */
+        scroll_up(screen, screen->scroll_top, screen->scroll_bottom, param(action, 0, 1));
+        break;
+    case 'T': /* SD */
+        scroll_down(screen, screen->scroll_top, screen->scroll_bottom, param(action, 0, 1));
+        break;
+    case 'X': /* ECH */
+        erase_cells(screen, row, col, col + param(action, 0, 1));
+        screen->is_wrap_pending = false;
+        break;
+    case 'd': /* VPA */
+        move_cursor(screen, param(action, 0, 1) - 1, col);
+        break;
+    case 'm':
+        select_graphic_rendition(screen, action);
+        break;
+    case 'r': { /* DECSTBM */
+        int top = param(action, 0, 1) - 1;
+        int bottom = param(action, 1, screen->rows) - 1;
+        if (bottom >= screen->rows) {
+            bottom = screen->rows - 1;
+        }
+        if (top < bottom) {
+            screen->scroll_top = top;
+            screen->scroll_bottom = bottom;
+            move_cursor(screen, 0, 0);
+        }
+        break;
+    }
+    case 's':
+        save_cursor(screen);
+        break;
+    case 'u':
+        restore_cursor(screen);
+        break;
+    default:
+        break;
+    }
+}
+
+static void select_graphic_rendition(ul_screen *screen, const ul_vt_action *action) {
+    uint32_t attr = screen->attr;
+
+    if (action->num_params == 0) {
+        screen->attr = UL_SCREEN_ATTR_DEFAULT;
+        return;
+    }
+
+    for (int i = 0; i < action->num_params; ++i) {
+        int value = action->params[i];
+
+        if (value == 0) {
+            attr = UL_SCREEN_ATTR_DEFAULT;
+        } else if (value == 1) {
+            attr |= UL_SCREEN_ATTR_BOLD;
+        } else if (value == 4) {
+            attr |= UL_SCREEN_ATTR_UNDERLINE;
+        } else if (value == 7) {
+            attr |= UL_SCREEN_ATTR_REVERSE;
+        } else if (value == 22) {
+            attr &= ~UL_SCREEN_ATTR_BOLD;
+        } else if (value == 24) {
+            attr &= ~UL_SCREEN_ATTR_UNDERLINE;
+        } else if (value == 27) {
+            attr &= ~UL_SCREEN_ATTR_REVERSE;
+        } else if ((value >= 30 && value <= 37) || (value >= 90 && value <= 97)) {
+            int index = value >= 90 ? value - 90 + 8 : value - 30;
+            attr = (attr & ~(0xffu | UL_SCREEN_ATTR_DEFAULT_FG)) | (uint32_t)index;
+        } else if ((value >= 40 && value <= 47) || (value >= 100 && value <= 107)) {
+            int index = value >= 100 ? value - 100 + 8 : value - 40;
+            attr = (attr & ~(0xff00u | UL_SCREEN_ATTR_DEFAULT_BG)) | ((uint32_t)index << 8);
+        } else if (value == 39) {
+            attr |= UL_SCREEN_ATTR_DEFAULT_FG;
+        } else if (value == 49) {
+            attr |= UL_SCREEN_ATTR_DEFAULT_BG;
+        } else if (value == 38 || value == 48) {
+            /* Extended colour: 5;index or 2;r;g;b */
+            int index = -1;
+            if (i + 2 < action->num_params && action->params[i + 1] == 5) {
+                index = action->params[i + 2] & 0xff;
+                i += 2;
+            } else if (i + 4 < action->num_params && action->params[i + 1] == 2) {
+                index = rgb_to_palette(action->params[i + 2], action->params[i + 3], action->params[i + 4]);
+                i += 4;
+            } else {
+                break;
+            }
+            if (value == 38) {
+                attr = (attr & ~(0xffu | UL_SCREEN_ATTR_DEFAULT_FG)) | (uint32_t)index;
+            } else {
+                attr = (attr & ~(0xff00u | UL_SCREEN_ATTR_DEFAULT_BG)) | ((uint32_t)index << 8);
+            }
+        }
+    }
+
+    screen->attr = attr;
+}
+
+static void set_private_mode(ul_screen *screen, const ul_vt_action *action, bool enable) {
+    for (int i = 0; i < action->num_params; ++i) {
+        switch (action->params[i]) {
+        case 7:
+            screen->is_auto_wrap = enable;
+            if (!enable) {
+                screen->is_wrap_pending = false;
+            }
+            break;
+        case 25:
+            screen->is_cursor_visible = enable;
+            ul_screen_mark_row_dirty(screen, screen->cursor_row);
+            break;
+        case 47:
+        case 1047:
+            use_alternate_grid(screen, enable);
+            break;
+        case 1049:
+            if (enable) {
+                save_cursor(screen);
+                use_alternate_grid(screen, true);
+                erase_rows(screen, 0, screen->rows);
+            } else {
+                use_alternate_grid(screen, false);
+                restore_cursor(screen);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+static void use_alternate_grid(ul_screen *screen, bool alternate) {
+    if (screen->is_alternate == alternate) {
+        return;
+    }
+
+    screen->is_alternate = alternate;
+    screen->cells = alternate ? screen->alternate : screen->primary;
+    mark_rows_dirty(screen, 0, screen->rows);
+}
+
+static void save_cursor(ul_screen *screen) {
+    screen->saved_cursor.row = screen->cursor_row;
+    screen->saved_cursor.col = screen->cursor_col;
+    screen->saved_cursor.attr = screen->attr;
+}
+
+static void restore_cursor(ul_screen *screen) {
+    move_cursor(screen, screen->saved_cursor.row, screen->saved_cursor.col);
+    screen->attr = screen->saved_cursor.attr;
+}
+
+static void reset(ul_screen *screen) {
+    use_alternate_grid(screen, false);
+    screen->attr = UL_SCREEN_ATTR_DEFAULT;
+    screen->cursor_row = 0;
+    screen->cursor_col = 0;
+    screen->is_cursor_visible = true;
+    screen->is_wrap_pending = false;
+    screen->is_auto_wrap = true;
+    screen->scroll_top = 0;
+    screen->scroll_bottom = screen->rows - 1;
+    save_cursor(screen);
+    erase_rows(screen, 0, screen->rows);
+}
+
+static int param(const ul_vt_action *action, int index, int fallback) {
+    if (index >= action->num_params || action->params[index] == 0) {
+        return fallback;
+    }
+    return action->params[index];
+}
+
+static uint8_t rgb_to_palette(int r, int g, int b) {
+    /* Cube levels are 0, 95, 135, 175, 215 and 255 */
+    int levels[3] = { r, g, b };
+    for (int i = 0; i < 3; ++i) {
+        levels[i] = levels[i] < 48 ? 0 : levels[i] < 115 ? 1 : (levels[i] - 35) / 40;
+        if (levels[i] > 5) {
+            levels[i] = 5;
+        }
+    }
+    return (uint8_t)(16 + 36 * levels[0] + 6 * levels[1] + levels[2]);
+}
+
+
+/**
+ * Public functions
+ */
+
+bool ul_screen_init(ul_screen *screen, int rows, int cols, size_t scrollback_lines) {
+    memset(screen, 0, sizeof(*screen));
+    pthread_mutex_init(&(screen->lock), NULL);
+
+    if (rows < 1) {
+        rows = 1;
+    }
+    if (cols < 1) {
+        cols = 1;
+    }
+
+    size_t num_cells = (size_t)rows * cols;
+    screen->primary = malloc(num_cells * sizeof(ul_screen_cell));
+    screen->alternate = malloc(num_cells * sizeof(ul_screen_cell));
+    screen->dirty = calloc((rows + 63) / 64, sizeof(uint64_t));
+    bool has_scrollback = ul_scrollback_init(&(screen->scrollback), scrollback_lines,
+        scrollback_lines * SCROLLBACK_CELLS_PER_LINE + cols);
+    if (!screen->primary || !screen->alternate || !screen->dirty || !has_scrollback) {
+        ul_screen_destroy(screen);
+        return false;
+    }
+
+    screen->rows = rows;
+    screen->cols = cols;
+
+    /* Blank both grids */
+    screen->attr = UL_SCREEN_ATTR_DEFAULT;
+    screen->cells = screen->alternate;
+    erase_rows(screen, 0, rows);
+    screen->cells = screen->primary;
+    reset(screen);
+    ul_utf8_decoder_init(&(screen->utf8));
+
+    return true;
+}
+
+void ul_screen_destroy(ul_screen *screen) {
+    free(screen->primary);
+    free(screen->alternate);
+    free(screen->dirty);
+    ul_scrollback_destroy(&(screen->scrollback));
+    pthread_mutex_destroy(&(screen->lock));
+    memset(screen, 0, sizeof(*screen));
+}
+
+void ul_screen_lock(ul_screen *screen) {
+    pthread_mutex_lock(&(screen->lock));
+}
+
+void ul_screen_unlock(ul_screen *screen) {
+    pthread_mutex_unlock(&(screen->lock));
+}
+
+void ul_screen_handle_action(const ul_vt_action *action, void *user_data) {
+    ul_screen *screen = user_data;
+    int cursor_row = screen->cursor_row;
+    int cursor_col = screen->cursor_col;
+
+    /* Anything but text cuts an unfinished UTF-8 sequence short */
+    uint32_t codepoint;
+    if (action->type != UL_VT_ACTION_PRINT && ul_utf8_decoder_flush(&(screen->utf8), &codepoint)) {
+        put_char(screen, codepoint);
+    }
+
+    switch (action->type) {
+    case UL_VT_ACTION_PRINT:
+        print(screen, action->data, action->length);
+        break;
+    case UL_VT_ACTION_EXECUTE:
+        execute(screen, action->byte);
+        break;
+    case UL_VT_ACTION_ESC_DISPATCH:
+        esc_dispatch(screen, action);
+        break;
+    case UL_VT_ACTION_CSI_DISPATCH:
+        csi_dispatch(screen, action);
+        break;
+    default:
+        break;
+    }
+
+    /* The cursor is drawn as part of its row, so both the row it left and the one it entered need repainting */
+    if (screen->cursor_row != cursor_row || screen->cursor_col != cursor_col) {
+        ul_screen_mark_row_dirty(screen, cursor_row);
+        ul_screen_mark_row_dirty(screen, screen->cursor_row);
+    }
+}
+
+const ul_screen_cell *ul_screen_get_row(const ul_screen *screen, int row) {
+    return &(screen->cells[(size_t)row * screen->cols]);
+}
+
+bool ul_screen_is_row_dirty(const ul_screen *screen, int row) {
+    return (screen->dirty[row / 64] >> (row % 64)) & 1;
+}
+
+void ul_screen_mark_row_dirty(ul_screen *screen, int row) {
+    screen->dirty[row / 64] |= (uint64_t)1 << (row % 64);
+}
+
+bool ul_screen_get_move(const ul_screen *screen, int *top, int *bottom, int *lines) {
+    *top = screen->moved_top;
+    *bottom = screen->moved_bottom;
+    *lines = screen->moved_lines;
+    return screen->is_region_moved;
+}
+
+void ul_screen_clear_dirty(ul_screen *screen) {
+    memset(screen->dirty, 0, (screen->rows + 63) / 64 * sizeof(uint64_t));
+    screen->is_region_moved = false;
+    screen->moved_lines = 0;
+}
+
+uint32_t ul_screen_get_palette_color(uint8_t index) {
+    static const uint32_t base_colors[16] = {
+        0x000000, 0xcd0000, 0x00cd00, 0xcdcd00, 0x0000ee, 0xcd00cd, 0x00cdcd, 0xe5e5e5,
+        0x7f7f7f, 0xff0000, 0x00ff00, 0xffff00, 0x5c5cff, 0xff00ff, 0x00ffff, 0xffffff
+    };
+
+    if (index < 16) {
+        return base_colors[index];
+    }
+
+    if (index < 232) {
+        int cube = index - 16;
+        int levels[3] = { cube / 36, (cube / 6) % 6, cube % 6 };
+        uint32_t color = 0;
+        for (int i = 0; i < 3; ++i) {
+            color = (color << 8) | (uint32_t)(levels[i] == 0 ? 0 : 55 + 40 * levels[i]);
+        }
+        return color;
+    }
+
+    uint32_t gray = 8 + 10 * (index - 232);
+    return (gray << 16) | (gray << 8) | gray;
+}
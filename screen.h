@@ -0,0 +1,190 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_SCREEN_H
+#define UL_SCREEN_H
+
+#include "scrollback.h"
+#include "utf8.h"
+#include "vt_parser.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Cell attributes: 8 bit foreground and background palette indices plus flags */
+#define UL_SCREEN_ATTR_FG(attr) ((uint8_t)((attr) & 0xff))
+#define UL_SCREEN_ATTR_BG(attr) ((uint8_t)(((attr) >> 8) & 0xff))
+#define UL_SCREEN_ATTR_BOLD (1u << 16)
+#define UL_SCREEN_ATTR_UNDERLINE (1u << 17)
+#define UL_SCREEN_ATTR_REVERSE (1u << 18)
+/* The colour index is ignored and the theme's default colour is used instead */
+#define UL_SCREEN_ATTR_DEFAULT_FG (1u << 19)
+#define UL_SCREEN_ATTR_DEFAULT_BG (1u << 20)
+
+#define UL_SCREEN_ATTR_DEFAULT (UL_SCREEN_ATTR_DEFAULT_FG | UL_SCREEN_ATTR_DEFAULT_BG)
+
+/* One character cell */
+typedef struct ul_screen_cell_t {
+    uint32_t codepoint;
+    uint32_t attr;
+} ul_screen_cell;
+
+/* Saved cursor state (DECSC / DECRC) */
+typedef struct {
+    int row;
+    int col;
+    uint32_t attr;
+} ul_screen_cursor;
+
+/* Terminal screen state. Fields may be read by the renderer but must only be changed through the functions below.
+ * While another thread applies output, every access has to happen between ul_screen_lock and ul_screen_unlock. */
+typedef struct {
+    pthread_mutex_t lock;
+    int rows;
+    int cols;
+    /* Active grid, rows * cols cells in row-major order. Points to either the primary or the alternate grid. */
+    ul_screen_cell *cells;
+    ul_screen_cell *primary;
+    ul_screen_cell *alternate;
+    bool is_alternate;
+    /* Cursor */
+    int cursor_row;
+    int cursor_col;
+    bool is_cursor_visible;
+    /* The last column has been written and the next printable character wraps */
+    bool is_wrap_pending;
+    bool is_auto_wrap;
+    ul_screen_cursor saved_cursor;
+    /* Attributes for newly written cells */
+    uint32_t attr;
+    /* Scrolling region (inclusive) */
+    int scroll_top;
+    int scroll_bottom;
+    /* One bit per row that changed since the last call to ul_screen_clear_dirty */
+    uint64_t *dirty;
+    /* Rows moved_top to moved_bottom (inclusive) scrolled up by moved_lines (down if negative) since the last call to
+     * ul_screen_clear_dirty. The dirty bits of moved rows travel with them, so a renderer that moves the pixels of the
+     * region along only has to redraw the dirty rows. Scrolls may cancel out, is_region_moved stays set then. */
+    bool is_region_moved;
+    int moved_top;
+    int moved_bottom;
+    int moved_lines;
+    /* Lines that scrolled off the top of the primary grid */
+    ul_scrollback scrollback;
+    /* UTF-8 sequence carried over between print runs */
+    ul_utf8_decoder utf8;
+} ul_screen;
+
+/**
+ * Allocate a blank screen.
+ *
+ * @param screen screen to initialise
+ * @param rows number of rows
+ * @param cols number of columns
+ * @param scrollback_lines maximum number of lines to keep after they scrolled off the screen
+ * @return true on success, false if memory could not be allocated
+ */
+bool ul_screen_init(ul_screen *screen, int rows, int cols, size_t scrollback_lines);
+
+/**
+ * Release the memory of a screen.
+ *
+ * @param screen screen to destroy
+ */
+void ul_screen_destroy(ul_screen *screen);
+
+/**
+ * Take exclusive access to the screen.
+ *
+ * @param screen screen to lock
+ */
+void ul_screen_lock(ul_screen *screen);
+
+/**
+ * Give up exclusive access to the screen.
+ *
+ * @param screen screen to unlock
+ */
+void ul_screen_unlock(ul_screen *screen);
+
+/**
+ * Apply a parsed action to the screen. Matches ul_vt_handler so that a parser can feed the screen directly.
+ *
+ * @param action parsed action
+ * @param user_data the ul_screen to update
+ */
+void ul_screen_handle_action(const ul_vt_action *action, void *user_data);
+
+/**
+ * Get the cells of a row.
+ *
+ * @param screen screen to query
+ * @param row row index
+ * @return pointer to cols cells
+ */
+const ul_screen_cell *ul_screen_get_row(const ul_screen *screen, int row);
+
+/**
+ * Check whether a row changed since the last call to ul_screen_clear_dirty.
+ *
+ * @param screen screen to query
+ * @param row row index
+ * @return true if the row needs to be redrawn
+ */
+bool ul_screen_is_row_dirty(const ul_screen *screen, int row);
+
+/**
+ * Mark a row as changed, e.g. because something drawn on top of it changed.
+ *
+ * @param screen screen to update
+ * @param row row index
+ */
+void ul_screen_mark_row_dirty(ul_screen *screen, int row);
+
+/**
+ * Check whether a region was scrolled since the last call to ul_screen_clear_dirty. Rows of the region that are not
+ * dirty only changed their position, rows that are dirty need to be redrawn at their new position.
+ *
+ * @param screen screen to query
+ * @param top pointer for writing the first row of the region
+ * @param bottom pointer for writing the last row of the region (inclusive)
+ * @param lines pointer for writing the number of rows the region moved up by (negative for down, 0 if scrolls
+ * cancelled out)
+ * @return true if the region was scrolled
+ */
+bool ul_screen_get_move(const ul_screen *screen, int *top, int *bottom, int *lines);
+
+/**
+ * Forget all changes after they have been handed to the renderer.
+ *
+ * @param screen screen to update
+ */
+void ul_screen_clear_dirty(ul_screen *screen);
+
+/**
+ * Look up a colour of the xterm 256 colour palette.
+ *
+ * @param index palette index
+ * @return colour as 0xRRGGBB
+ */
+uint32_t ul_screen_get_palette_color(uint8_t index);
+
+#endif /* UL_SCREEN_H */
@@ -0,0 +1,129 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "scrollback.h"
+
+#include "screen.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Drop the oldest line.
+ *
+ * @param scrollback scrollback
+ */
+static void evict_oldest(ul_scrollback *scrollback);
+
+
+/**
+ * Static functions
+ */
+
+static void evict_oldest(ul_scrollback *scrollback) {
+    scrollback->first = (scrollback->first + 1) % scrollback->max_lines;
+    scrollback->count--;
+}
+
+
+/**
+ * Public functions
+ */
+
+bool ul_scrollback_init(ul_scrollback *scrollback, size_t max_lines, size_t capacity) {
+    memset(scrollback, 0, sizeof(*scrollback));
+
+    if (max_lines == 0) {
+        return true;
+    }
+
+    scrollback->lines = malloc(max_lines * sizeof(ul_scrollback_line));
+    scrollback->cells = malloc(capacity * sizeof(ul_screen_cell));
+    if (!scrollback->lines || !scrollback->cells) {
+        ul_scrollback_destroy(scrollback);
+        return false;
+    }
+
+    scrollback->max_lines = max_lines;
+    scrollback->capacity = capacity;
+    return true;
+}
+
+void ul_scrollback_destroy(ul_scrollback *scrollback) {
+    free(scrollback->lines);
+    free(scrollback->cells);
+    memset(scrollback, 0, sizeof(*scrollback));
+}
+
+void ul_scrollback_push(ul_scrollback *scrollback, const ul_screen_cell *cells, int length) {
+    if (scrollback->max_lines == 0) {
+        return;
+    }
+
+    /* Trailing blanks are implied */
+    while (length > 0 && cells[length - 1].codepoint == ' ' && cells[length - 1].attr == UL_SCREEN_ATTR_DEFAULT) {
+        --length;
+    }
+    if ((size_t)length > scrollback->capacity) {
+        length = scrollback->capacity;
+    }
+
+    /* Lines are stored contiguously, skip the end of the arena if the line would wrap around */
+    uint64_t start = scrollback->head;
+    size_t offset = start % scrollback->capacity;
+    if (offset + length > scrollback->capacity) {
+        start += scrollback->capacity - offset;
+        offset = 0;
+    }
+    scrollback->head = start + length;
+
+    /* Make room: every line starting before head - capacity is about to be overwritten */
+    uint64_t limit = scrollback->head > scrollback->capacity ? scrollback->head - scrollback->capacity : 0;
+    while (scrollback->count > 0 && scrollback->lines[scrollback->first].start < limit) {
+        evict_oldest(scrollback);
+    }
+    if (scrollback->count == scrollback->max_lines) {
+        evict_oldest(scrollback);
+    }
+
+    memcpy(&(scrollback->cells[offset]), cells, length * sizeof(ul_screen_cell));
+
+    size_t index = (scrollback->first + scrollback->count) % scrollback->max_lines;
+    scrollback->lines[index].start = start;
+    scrollback->lines[index].length = length;
+    scrollback->count++;
+    scrollback->pushed++;
+}
+
+void ul_scrollback_clear(ul_scrollback *scrollback) {
+    scrollback->first = 0;
+    scrollback->count = 0;
+}
+
+const ul_screen_cell *ul_scrollback_get_line(const ul_scrollback *scrollback, size_t index, int *length) {
+    const ul_scrollback_line *line = &(scrollback->lines[(scrollback->first + index) % scrollback->max_lines]);
+    *length = line->length;
+    return &(scrollback->cells[line->start % scrollback->capacity]);
+}
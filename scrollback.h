@@ -0,0 +1,103 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_SCROLLBACK_H
+#define UL_SCROLLBACK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Cells are defined by the screen, forward declared to avoid a circular include */
+struct ul_screen_cell_t;
+
+/* Location of one line in the cell arena */
+typedef struct {
+    /* Arena position of the first cell, counted from the creation of the scrollback */
+    uint64_t start;
+    /* Number of cells, trailing blanks are not stored */
+    uint32_t length;
+} ul_scrollback_line;
+
+/**
+ * Lines that scrolled off the top of the screen. Line cells are kept back to back in a ring shaped arena and
+ * indexed by a ring of line records, so that appending and evicting the oldest line are both O(1).
+ */
+typedef struct {
+    /* Line records, max_lines entries */
+    ul_scrollback_line *lines;
+    size_t max_lines;
+    /* Index of the oldest line and number of stored lines */
+    size_t first;
+    size_t count;
+    /* Cell arena */
+    struct ul_screen_cell_t *cells;
+    size_t capacity;
+    /* Arena position where the next line is written */
+    uint64_t head;
+    /* Number of lines appended so far. Evicting or clearing lines leaves it alone, so that readers can tell how far
+     * the stored lines moved up since they last looked. */
+    uint64_t pushed;
+} ul_scrollback;
+
+/**
+ * Allocate an empty scrollback.
+ *
+ * @param scrollback scrollback to initialise
+ * @param max_lines maximum number of lines to keep
+ * @param capacity number of cells in the arena, at least as many as in the widest line
+ * @return true on success, false if memory could not be allocated
+ */
+bool ul_scrollback_init(ul_scrollback *scrollback, size_t max_lines, size_t capacity);
+
+/**
+ * Release the memory of a scrollback.
+ *
+ * @param scrollback scrollback to destroy
+ */
+void ul_scrollback_destroy(ul_scrollback *scrollback);
+
+/**
+ * Append a line, evicting the oldest lines if the scrollback is full.
+ *
+ * @param scrollback scrollback to append to
+ * @param cells cells of the line
+ * @param length number of cells
+ */
+void ul_scrollback_push(ul_scrollback *scrollback, const struct ul_screen_cell_t *cells, int length);
+
+/**
+ * Remove all lines.
+ *
+ * @param scrollback scrollback to clear
+ */
+void ul_scrollback_clear(ul_scrollback *scrollback);
+
+/**
+ * Get a stored line.
+ *
+ * @param scrollback scrollback to query
+ * @param index line index, 0 being the oldest line
+ * @param length pointer for writing the number of stored cells into
+ * @return cells of the line
+ */
+const struct ul_screen_cell_t *ul_scrollback_get_line(const ul_scrollback *scrollback, size_t index, int *length);
+
+#endif /* UL_SCROLLBACK_H */
@@ -0,0 +1,276 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "slide.h"
+
+#include "log.h"
+
+#include <stdlib.h>
+
+
+/**
+ * Defines
+ */
+
+/* Where the picture of the sliding widget is shown */
+typedef enum {
+    SLIDE_MODE_NONE = 0,
+    SLIDE_MODE_PLANE,
+    SLIDE_MODE_PICTURE
+} slide_mode;
+
+
+/**
+ * Static variables
+ */
+
+static ul_slide_load_cb plane_load_cb = NULL;
+static ul_slide_move_cb plane_move_cb = NULL;
+static ul_slide_hide_cb plane_hide_cb = NULL;
+
+static slide_mode mode = SLIDE_MODE_NONE;
+/* Widget that is sliding and its current y offset */
+static lv_obj_t *slide_obj = NULL;
+static lv_coord_t slide_y = 0;
+/* Screen position of the widget at y offset 0 */
+static lv_coord_t screen_x = 0;
+static lv_coord_t screen_y = 0;
+
+/* Rendered widget, including the margin that LVGL draws around it for shadows and outlines */
+static lv_img_dsc_t snapshot;
+static uint8_t *snapshot_buf = NULL;
+static uint32_t snapshot_buf_size = 0;
+static lv_coord_t snapshot_margin = 0;
+
+/* Image object standing in for the widget when there is no plane */
+static lv_obj_t *picture = NULL;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Render a widget into the snapshot buffer.
+ *
+ * @param obj widget
+ * @return true on success, false if the widget could not be rendered
+ */
+static bool take_snapshot(lv_obj_t *obj);
+
+/**
+ * Show the snapshot with an LVGL image object in place of the sliding widget.
+ */
+static void show_picture(void);
+
+/**
+ * Move the picture of the sliding widget.
+ *
+ * @param y y offset of the widget
+ */
+static void move_to(lv_coord_t y);
+
+/**
+ * Put the sliding widget back in place of its picture.
+ */
+static void end_slide(void);
+
+/**
+ * Animation callback for sliding a picture of the widget.
+ *
+ * @param obj widget
+ * @param value y offset
+ */
+static void slide_anim_cb(void *obj, int32_t value);
+
+/**
+ * Animation callback for sliding the widget itself when it could not be rendered into a picture.
+ *
+ * @param obj widget
+ * @param value y offset
+ */
+static void obj_anim_cb(void *obj, int32_t value);
+
+/**
+ * Handle the end of the slide animation.
+ *
+ * @param anim animation
+ */
+static void slide_ready_cb(lv_anim_t *anim);
+
+
+/**
+ * Static functions
+ */
+
+static bool take_snapshot(lv_obj_t *obj) {
+    const uint32_t size = lv_snapshot_buf_size_needed(obj, LV_IMG_CF_TRUE_COLOR);
+    if (size == 0) {
+        return false;
+    }
+
+    if (size > snapshot_buf_size) {
+        uint8_t *grown = realloc(snapshot_buf, size);
+        if (!grown) {
+            ul_log(UL_LOG_LEVEL_WARNING, "Could not allocate %u bytes for sliding a widget", size);
+            return false;
+        }
+        snapshot_buf = grown;
+        snapshot_buf_size = size;
+    }
+
+    if (lv_snapshot_take_to_buf(obj, LV_IMG_CF_TRUE_COLOR, &snapshot, snapshot_buf, snapshot_buf_size) != LV_RES_OK) {
+        return false;
+    }
+
+    /* The descriptor is reused for every snapshot, drop whatever LVGL cached about the previous one */
+    lv_img_cache_invalidate_src(&snapshot);
+    snapshot_margin = ((lv_coord_t)snapshot.header.w - lv_obj_get_width(obj)) / 2;
+    return true;
+}
+
+static void show_picture(void) {
+    lv_obj_t *parent = lv_obj_get_parent(slide_obj);
+    if (picture && lv_obj_get_parent(picture) != parent) {
+        lv_obj_del(picture);
+        picture = NULL;
+    }
+    if (!picture) {
+        picture = lv_img_create(parent);
+    }
+
+    /* Same size and alignment as the widget, with the margin cropped off */
+    lv_img_set_src(picture, &snapshot);
+    lv_img_set_offset_x(picture, -snapshot_margin);
+    lv_img_set_offset_y(picture, -snapshot_margin);
+    lv_obj_set_size(picture, lv_obj_get_width(slide_obj), lv_obj_get_height(slide_obj));
+    lv_obj_align(picture, lv_obj_get_style_align(slide_obj, LV_PART_MAIN), lv_obj_get_style_x(slide_obj, LV_PART_MAIN),
+        slide_y);
+    lv_obj_clear_flag(picture, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_move_foreground(picture);
+
+    mode = SLIDE_MODE_PICTURE;
+}
+
+static void move_to(lv_coord_t y) {
+    slide_y = y;
+
+    if (mode == SLIDE_MODE_PLANE) {
+        if (plane_move_cb(screen_x, screen_y + y)) {
+            return;
+        }
+        ul_log(UL_LOG_LEVEL_WARNING, "Could not move the hardware plane, sliding in software from now on");
+        plane_load_cb = NULL;
+        plane_move_cb = NULL;
+        plane_hide_cb = NULL;
+        show_picture();
+    }
+
+    lv_obj_set_y(picture, y);
+}
+
+static void end_slide(void) {
+    lv_obj_set_y(slide_obj, slide_y);
+    lv_obj_clear_flag(slide_obj, LV_OBJ_FLAG_HIDDEN);
+
+    /* The widget is rendered into the next frame, which is when the stand-in can go */
+    if (mode == SLIDE_MODE_PLANE) {
+        plane_hide_cb();
+    } else if (mode == SLIDE_MODE_PICTURE) {
+        lv_obj_add_flag(picture, LV_OBJ_FLAG_HIDDEN);
+    }
+
+    mode = SLIDE_MODE_NONE;
+    slide_obj = NULL;
+}
+
+static void slide_anim_cb(void *obj, int32_t value) {
+    LV_UNUSED(obj);
+    move_to((lv_coord_t)value);
+}
+
+static void obj_anim_cb(void *obj, int32_t value) {
+    lv_obj_set_y(obj, (lv_coord_t)value);
+}
+
+static void slide_ready_cb(lv_anim_t *anim) {
+    LV_UNUSED(anim);
+    if (slide_obj) {
+        end_slide();
+    }
+}
+
+
+/**
+ * Public functions
+ */
+
+void ul_slide_set_plane(ul_slide_load_cb load_cb, ul_slide_move_cb move_cb, ul_slide_hide_cb hide_cb) {
+    plane_load_cb = load_cb;
+    plane_move_cb = move_cb;
+    plane_hide_cb = hide_cb;
+}
+
+void ul_slide_start(lv_obj_t *obj, lv_coord_t from_y, lv_coord_t to_y, uint32_t time, lv_anim_path_cb_t path_cb) {
+    /* Settle a slide that is still going on where it currently is */
+    lv_anim_del(obj, NULL);
+    if (slide_obj) {
+        lv_anim_del(slide_obj, NULL);
+        end_slide();
+    }
+
+    lv_obj_set_y(obj, from_y);
+    lv_obj_update_layout(obj);
+
+    lv_anim_t anim;
+    lv_anim_init(&anim);
+    lv_anim_set_var(&anim, obj);
+    lv_anim_set_values(&anim, from_y, to_y);
+    lv_anim_set_path_cb(&anim, path_cb);
+    lv_anim_set_time(&anim, time);
+
+    if (!take_snapshot(obj)) {
+        lv_anim_set_exec_cb(&anim, obj_anim_cb);
+        lv_anim_start(&anim);
+        return;
+    }
+
+    slide_obj = obj;
+    slide_y = from_y;
+    screen_x = obj->coords.x1;
+    screen_y = obj->coords.y1 - from_y;
+
+    const lv_coord_t stride = (lv_coord_t)snapshot.header.w;
+    const lv_color_t *pixels = (const lv_color_t *)snapshot_buf + (size_t)snapshot_margin * stride + snapshot_margin;
+    if (plane_load_cb && plane_load_cb(pixels, stride, lv_obj_get_width(obj), lv_obj_get_height(obj))) {
+        mode = SLIDE_MODE_PLANE;
+    } else {
+        show_picture();
+    }
+
+    /* Bring the picture into place before the widget disappears from the frame */
+    move_to(from_y);
+    lv_obj_add_flag(obj, LV_OBJ_FLAG_HIDDEN);
+
+    lv_anim_set_exec_cb(&anim, slide_anim_cb);
+    lv_anim_set_ready_cb(&anim, slide_ready_cb);
+    lv_anim_start(&anim);
+}
@@ -0,0 +1,62 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef UL_SLIDE_H
+#define UL_SLIDE_H
+
+#include "lvgl/lvgl.h"
+
+#include <stdbool.h>
+
+/* Load a picture of width x height pixels, whose rows are stride pixels apart, into a hardware plane above the frame.
+ * Returns false if there is no plane that can show it. */
+typedef bool (*ul_slide_load_cb)(const lv_color_t *pixels, lv_coord_t stride, lv_coord_t width, lv_coord_t height);
+
+/* Show the loaded picture with its top left corner at a screen position, clipped to the screen. Returns false if the
+ * plane could not be moved. */
+typedef bool (*ul_slide_move_cb)(lv_coord_t x, lv_coord_t y);
+
+/* Take the plane down once the next rendered frame is on screen */
+typedef void (*ul_slide_hide_cb)(void);
+
+/**
+ * Set the hardware plane that slid widgets are shown on. Without one they are drawn as pictures by LVGL.
+ *
+ * @param load_cb function to load a picture into the plane
+ * @param move_cb function to move the plane
+ * @param hide_cb function to take the plane down
+ */
+void ul_slide_set_plane(ul_slide_load_cb load_cb, ul_slide_move_cb move_cb, ul_slide_hide_cb hide_cb);
+
+/**
+ * Animate the vertical offset of a widget without rendering it on every step. The widget is rendered once into a
+ * picture that stands in for it until the animation is over. The picture is moved on the hardware plane if there is
+ * one, which costs no rendering at all, and copied by LVGL otherwise.
+ *
+ * @param obj widget to move, must not change while it slides
+ * @param from_y y offset to start from
+ * @param to_y y offset to end at
+ * @param time duration in milliseconds
+ * @param path_cb animation path
+ */
+void ul_slide_start(lv_obj_t *obj, lv_coord_t from_y, lv_coord_t to_y, uint32_t time, lv_anim_path_cb_t path_cb);
+
+#endif /* UL_SLIDE_H */
@@ -0,0 +1,1178 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "term_widget.h"
+
+#include "blend.h"
+#include "display.h"
+#include "log.h"
+#include "pool.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * Defines
+ */
+
+#define MY_CLASS &ul_term_widget_class
+
+#define ATLAS_SIZE (UL_TERM_WIDGET_ATLAS_LAST - UL_TERM_WIDGET_ATLAS_FIRST + 1)
+
+/* Widest cell that fits into a glyph row word */
+#define MAX_BITS_CELL_WIDTH 32
+
+/* Pixel selection masks for the four pixels of a nibble of glyph bits, leftmost pixel first */
+#define BIT_MASK(bit) ((bit) ? UINT32_MAX : 0)
+#define NIBBLE_MASKS(n) { BIT_MASK((n) & 8), BIT_MASK((n) & 4), BIT_MASK((n) & 2), BIT_MASK((n) & 1) }
+
+/* Rows drawn by one job of the render pool, and the fewest rows worth splitting up */
+#define BAND_ROWS 4
+#define MIN_PARALLEL_ROWS 16
+
+/* Rows to be drawn by the render pool, one band of BAND_ROWS per job */
+typedef struct {
+    ul_term_widget_t *term;
+    lv_draw_ctx_t *draw_ctx;
+    const lv_area_t *clip_area;
+    int first_row;
+    int last_row;
+    int first_col;
+    int last_col;
+} row_bands;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Initialise a new widget.
+ *
+ * @param class_p widget class
+ * @param obj the widget
+ */
+static void constructor(const lv_obj_class_t *class_p, lv_obj_t *obj);
+
+/**
+ * Release the resources of a widget.
+ *
+ * @param class_p widget class
+ * @param obj the widget
+ */
+static void destructor(const lv_obj_class_t *class_p, lv_obj_t *obj);
+
+/**
+ * Handle events sent to the widget.
+ *
+ * @param class_p widget class
+ * @param event the event object
+ */
+static void event_cb(const lv_obj_class_t *class_p, lv_event_t *event);
+
+/**
+ * Lock the screen shown by the widget, if there is one.
+ *
+ * @param term terminal widget
+ */
+static void lock_screen(ul_term_widget_t *term);
+
+/**
+ * Unlock the screen shown by the widget, if there is one.
+ *
+ * @param term terminal widget
+ */
+static void unlock_screen(ul_term_widget_t *term);
+
+/**
+ * Draw the part of the widget that lies within the draw context's clip area.
+ *
+ * @param term terminal widget
+ * @param draw_ctx draw context
+ */
+static void draw(ul_term_widget_t *term, lv_draw_ctx_t *draw_ctx);
+
+/**
+ * Draw rows on all threads of the render pool. Bands of rows cover disjoint parts of the draw buffer, so they can be
+ * drawn concurrently as long as no glyph has to be rasterised on the way.
+ *
+ * @param bands rows to draw
+ * @return true if the rows were drawn, false if they have to be drawn on the calling thread
+ */
+static bool draw_rows_in_parallel(row_bands *bands);
+
+/**
+ * Draw one band of rows. Job function of the render pool.
+ *
+ * @param index band index
+ * @param user_data the row_bands to draw
+ */
+static void draw_band_cb(size_t index, void *user_data);
+
+/**
+ * Rasterise the characters outside the atlas that are about to be drawn, so that drawing only reads the glyph cache.
+ *
+ * @param bands rows to be drawn
+ * @return true if all of them fit into the cache at once
+ */
+static bool prepare_extra_glyphs(row_bands *bands);
+
+/**
+ * Draw the visible cells of one row, copying its pixels from the row cache if the same content was drawn before.
+ *
+ * @param term terminal widget
+ * @param draw_ctx draw context
+ * @param clip_area area to draw into
+ * @param row row index
+ * @param cells cells to draw
+ * @param length number of cells, columns beyond it are blank
+ * @param first_col first visible column
+ * @param last_col last visible column
+ */
+static void draw_row_cached(ul_term_widget_t *term, lv_draw_ctx_t *draw_ctx, const lv_area_t *clip_area, int row,
+    const ul_screen_cell *cells, int length, int first_col, int last_col);
+
+/**
+ * Draw the visible cells of one row.
+ *
+ * @param term terminal widget
+ * @param draw_ctx draw context
+ * @param clip_area area to draw into
+ * @param row row index
+ * @param cells cells to draw
+ * @param length number of cells, columns beyond it are blank
+ * @param first_col first visible column
+ * @param last_col last visible column
+ */
+static void draw_row(ul_term_widget_t *term, lv_draw_ctx_t *draw_ctx, const lv_area_t *clip_area, int row,
+    const ul_screen_cell *cells, int length, int first_col, int last_col);
+
+/**
+ * Get the cells shown in a row of the view, which may come from the scrollback.
+ *
+ * @param term terminal widget
+ * @param row row index of the view
+ * @param length pointer for writing the number of cells into
+ * @return cells of the row
+ */
+static const ul_screen_cell *get_view_row(const ul_term_widget_t *term, int row, int *length);
+
+/**
+ * Get the number of scrollback lines shown above the screen. A view that is scrolled back stays on the same lines
+ * while new ones are pushed into the scrollback, so the offset grows by the lines pushed since it was last updated.
+ * It is clamped to what is left of the scrollback in case lines were evicted or cleared (ED 3).
+ *
+ * @param term terminal widget
+ * @return number of scrollback lines in the view
+ */
+static size_t get_view_offset(const ul_term_widget_t *term);
+
+/**
+ * Fold the lines pushed into the scrollback since the last update into the view offset. Must be called with the
+ * screen locked.
+ *
+ * @param term terminal widget
+ */
+static void anchor_view(ul_term_widget_t *term);
+
+/**
+ * Scroll the view through the scrollback.
+ *
+ * @param term terminal widget
+ * @param lines number of lines to scroll towards older output (negative for newer output)
+ */
+static void scroll_view(ul_term_widget_t *term, int lines);
+
+/**
+ * Scroll rows by moving their pixels in the frame instead of redrawing them.
+ *
+ * @param term terminal widget
+ * @param top first row of the scrolled region
+ * @param bottom last row of the scrolled region (inclusive)
+ * @param lines number of rows the region moved up by (negative for down)
+ * @return true if the pixels were moved, false if the region has to be redrawn
+ */
+static bool move_rows(ul_term_widget_t *term, int top, int bottom, int lines);
+
+/**
+ * Check whether an area of the widget is fully visible and nothing is drawn on top of it.
+ *
+ * @param term terminal widget
+ * @param area area in display coordinates
+ * @return true if the area only shows the widget
+ */
+static bool is_area_exposed(ul_term_widget_t *term, const lv_area_t *area);
+
+/**
+ * Check whether visible children of an object overlap an area.
+ *
+ * @param parent object whose children to check
+ * @param first_index index of the first child to check
+ * @param area area in display coordinates
+ * @return true if a child overlaps the area
+ */
+static bool is_covered_by_children(lv_obj_t *parent, uint32_t first_index, const lv_area_t *area);
+
+/**
+ * Draw the cursor and the text that is being typed.
+ *
+ * @param term terminal widget
+ * @param draw_ctx draw context
+ * @param clip_area area to draw into
+ */
+static void draw_cursor(ul_term_widget_t *term, lv_draw_ctx_t *draw_ctx, const lv_area_t *clip_area);
+
+/**
+ * Draw one character cell.
+ *
+ * @param term terminal widget
+ * @param draw_ctx draw context
+ * @param clip_area area to draw into
+ * @param row row index
+ * @param col column index
+ * @param glyph opacity map of the character or NULL for a blank cell
+ * @param fg text colour
+ * @param bg background colour
+ * @param is_underlined true if the cell is underlined
+ */
+static void draw_cell(ul_term_widget_t *term, lv_draw_ctx_t *draw_ctx, const lv_area_t *clip_area, int row, int col,
+    const lv_opa_t *glyph, lv_color_t fg, lv_color_t bg, bool is_underlined);
+
+/**
+ * Expand a row of glyph bits into text and background pixels, four pixels per table lookup.
+ *
+ * @param dst pixels to write
+ * @param bits glyph row, first pixel in the highest bit
+ * @param width number of pixels
+ * @param fg text colour
+ * @param bg background colour
+ */
+static void expand_bits(lv_color_t *dst, uint32_t bits, lv_coord_t width, lv_color_t fg, lv_color_t bg);
+
+/**
+ * Fill an area of the draw buffer with a solid colour.
+ *
+ * @param draw_ctx draw context
+ * @param area area to fill, must lie within the draw buffer
+ * @param color fill colour
+ */
+static void fill_area(lv_draw_ctx_t *draw_ctx, const lv_area_t *area, lv_color_t color);
+
+/**
+ * Look up a character in the glyph atlas, rasterising characters outside of it on demand.
+ *
+ * @param term terminal widget
+ * @param codepoint character
+ * @return opacity map of the character or NULL if it is blank
+ */
+static const lv_opa_t *get_glyph(ul_term_widget_t *term, uint32_t codepoint);
+
+/**
+ * Look up the bit rows of a glyph returned by get_glyph.
+ *
+ * @param term terminal widget
+ * @param glyph opacity map of the glyph
+ * @return cell_height glyph rows or NULL if the font is anti-aliased
+ */
+static const uint32_t *get_glyph_bits(const ul_term_widget_t *term, const lv_opa_t *glyph);
+
+/**
+ * Pack an opacity map of a 1 bpp glyph into one word per row.
+ *
+ * @param glyph opacity map of cell_width * cell_height pixels
+ * @param bits cell_height words to write
+ * @param cell_width width of a cell, at most MAX_BITS_CELL_WIDTH
+ * @param cell_height height of a cell
+ */
+static void pack_glyph_bits(const lv_opa_t *glyph, uint32_t *bits, lv_coord_t cell_width, lv_coord_t cell_height);
+
+/**
+ * Resolve the colours of a cell.
+ *
+ * @param term terminal widget
+ * @param attr cell attributes
+ * @param fg pointer for writing the text colour
+ * @param bg pointer for writing the background colour
+ */
+static void resolve_colors(const ul_term_widget_t *term, uint32_t attr, lv_color_t *fg, lv_color_t *bg);
+
+/**
+ * Rasterise one character of a font into an opacity map.
+ *
+ * @param font font
+ * @param codepoint character
+ * @param glyph zeroed opacity map of cell_width * cell_height pixels to draw into
+ * @param cell_width width of a cell
+ * @param cell_height height of a cell
+ * @return true if the font has the character
+ */
+static bool rasterize_glyph(const lv_font_t *font, uint32_t codepoint, lv_opa_t *glyph, lv_coord_t cell_width,
+    lv_coord_t cell_height);
+
+/**
+ * Rasterise the atlas characters of a font into opacity maps.
+ *
+ * @param font font
+ * @param cell_width width of a cell
+ * @param cell_height height of a cell
+ * @return the atlas or NULL if it could not be allocated
+ */
+static lv_opa_t *build_atlas(const lv_font_t *font, lv_coord_t cell_width, lv_coord_t cell_height);
+
+
+/**
+ * Static variables
+ */
+
+static const uint32_t nibble_masks[16][4] = {
+    NIBBLE_MASKS(0), NIBBLE_MASKS(1), NIBBLE_MASKS(2), NIBBLE_MASKS(3),
+    NIBBLE_MASKS(4), NIBBLE_MASKS(5), NIBBLE_MASKS(6), NIBBLE_MASKS(7),
+    NIBBLE_MASKS(8), NIBBLE_MASKS(9), NIBBLE_MASKS(10), NIBBLE_MASKS(11),
+    NIBBLE_MASKS(12), NIBBLE_MASKS(13), NIBBLE_MASKS(14), NIBBLE_MASKS(15)
+};
+
+const lv_obj_class_t ul_term_widget_class = {
+    .base_class = &lv_obj_class,
+    .constructor_cb = constructor,
+    .destructor_cb = destructor,
+    .event_cb = event_cb,
+    .instance_size = sizeof(ul_term_widget_t)
+};
+
+
+/**
+ * Static functions
+ */
+
+static void constructor(const lv_obj_class_t *class_p, lv_obj_t *obj) {
+    LV_UNUSED(class_p);
+    ul_term_widget_t *term = (ul_term_widget_t *)obj;
+
+    term->screen = NULL;
+    term->font = NULL;
+    term->cell_width = 0;
+    term->cell_height = 0;
+    term->atlas = NULL;
+    memset(term->extra_codepoints, 0, sizeof(term->extra_codepoints));
+    term->extra_glyphs = NULL;
+    term->atlas_bits = NULL;
+    term->extra_bits = NULL;
+    term->default_fg = lv_color_white();
+    term->default_bg = lv_color_black();
+    for (int i = 0; i < 256; ++i) {
+        term->palette[i] = lv_color_hex(ul_screen_get_palette_color(i));
+    }
+    term->preedit = NULL;
+    term->preedit_length = 0;
+    term->preedit_pos = 0;
+    term->view_offset = 0;
+    term->view_pushed = 0;
+    term->drag_remainder = 0;
+    term->drawn_first_row = INT_MAX;
+    term->drawn_last_row = -1;
+    term->drawn_cursor_row = -1;
+    ul_rowcache_init(&(term->row_cache), 0);
+
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_SCROLLABLE);
+}
+
+static void destructor(const lv_obj_class_t *class_p, lv_obj_t *obj) {
+    LV_UNUSED(class_p);
+    ul_term_widget_t *term = (ul_term_widget_t *)obj;
+
+    free(term->atlas);
+    term->atlas = NULL;
+    free(term->extra_glyphs);
+    term->extra_glyphs = NULL;
+    free(term->atlas_bits);
+    term->atlas_bits = NULL;
+    free(term->extra_bits);
+    term->extra_bits = NULL;
+    ul_rowcache_destroy(&(term->row_cache));
+}
+
+static void event_cb(const lv_obj_class_t *class_p, lv_event_t *event) {
+    LV_UNUSED(class_p);
+
+    if (lv_obj_event_base(MY_CLASS, event) != LV_RES_OK) {
+        return;
+    }
+
+    ul_term_widget_t *term = (ul_term_widget_t *)lv_event_get_target(event);
+    lv_event_code_t code = lv_event_get_code(event);
+
+    if (code == LV_EVENT_COVER_CHECK) {
+        /* Every pixel is painted, so nothing underneath needs to be drawn */
+        lv_cover_check_info_t *info = lv_event_get_param(event);
+        if (info->res != LV_COVER_RES_MASKED && _lv_area_is_in(info->area, &(term->obj.coords), 0)) {
+            info->res = LV_COVER_RES_COVER;
+        }
+    } else if (code == LV_EVENT_DRAW_MAIN) {
+        /* The output thread keeps changing the screen, hold it still while painting */
+        lock_screen(term);
+        draw(term, lv_event_get_draw_ctx(event));
+        unlock_screen(term);
+    } else if (code == LV_EVENT_PRESSING) {
+        /* Dragging down reveals older output */
+        lv_point_t vect;
+        lv_indev_get_vect(lv_indev_get_act(), &vect);
+        if (term->cell_height > 0) {
+            term->drag_remainder += vect.y;
+            int lines = term->drag_remainder / term->cell_height;
+            term->drag_remainder -= lines * term->cell_height;
+            lock_screen(term);
+            scroll_view(term, lines);
+            unlock_screen(term);
+        }
+    } else if (code == LV_EVENT_RELEASED || code == LV_EVENT_PRESS_LOST) {
+        term->drag_remainder = 0;
+    }
+}
+
+static void lock_screen(ul_term_widget_t *term) {
+    if (term->screen) {
+        ul_screen_lock(term->screen);
+    }
+}
+
+static void unlock_screen(ul_term_widget_t *term) {
+    if (term->screen) {
+        ul_screen_unlock(term->screen);
+    }
+}
+
+static void draw(ul_term_widget_t *term, lv_draw_ctx_t *draw_ctx) {
+    const lv_area_t *coords = &(term->obj.coords);
+
+    lv_area_t clip_area;
+    if (!_lv_area_intersect(&clip_area, draw_ctx->clip_area, coords)) {
+        return;
+    }
+
+    ul_screen *screen = term->screen;
+    if (!screen || !term->atlas) {
+        fill_area(draw_ctx, &clip_area, term->default_bg);
+        return;
+    }
+
+    /* Margins to the right and below the grid */
+    lv_area_t grid = {
+        .x1 = coords->x1,
+        .y1 = coords->y1,
+        .x2 = coords->x1 + screen->cols * term->cell_width - 1,
+        .y2 = coords->y1 + screen->rows * term->cell_height - 1
+    };
+    lv_area_t margins[2] = {
+        { .x1 = grid.x2 + 1, .y1 = coords->y1, .x2 = coords->x2, .y2 = coords->y2 },
+        { .x1 = coords->x1, .y1 = grid.y2 + 1, .x2 = grid.x2, .y2 = coords->y2 }
+    };
+    for (int i = 0; i < 2; ++i) {
+        lv_area_t area;
+        if (_lv_area_intersect(&area, &(margins[i]), &clip_area)) {
+            fill_area(draw_ctx, &area, term->default_bg);
+        }
+    }
+
+    /* Cells */
+    lv_area_t cells_area;
+    if (!_lv_area_intersect(&cells_area, &grid, &clip_area)) {
+        return;
+    }
+
+    int first_row = (cells_area.y1 - coords->y1) / term->cell_height;
+    int last_row = (cells_area.y2 - coords->y1) / term->cell_height;
+    int first_col = (cells_area.x1 - coords->x1) / term->cell_width;
+    int last_col = (cells_area.x2 - coords->x1) / term->cell_width;
+
+    term->drawn_first_row = LV_MIN(term->drawn_first_row, first_row);
+    term->drawn_last_row = LV_MAX(term->drawn_last_row, last_row);
+
+    row_bands bands = {
+        .term = term,
+        .draw_ctx = draw_ctx,
+        .clip_area = &cells_area,
+        .first_row = first_row,
+        .last_row = last_row,
+        .first_col = first_col,
+        .last_col = last_col
+    };
+    if (!draw_rows_in_parallel(&bands)) {
+        for (int row = first_row; row <= last_row; ++row) {
+            int length;
+            const ul_screen_cell *cells = get_view_row(term, row, &length);
+            draw_row_cached(term, draw_ctx, &cells_area, row, cells, length, first_col, last_col);
+        }
+    }
+
+    int cursor_row = screen->cursor_row + (int)get_view_offset(term);
+    if (cursor_row >= first_row && cursor_row <= last_row) {
+        draw_cursor(term, draw_ctx, &cells_area);
+    }
+}
+
+static bool draw_rows_in_parallel(row_bands *bands) {
+    const int num_rows = bands->last_row - bands->first_row + 1;
+    if (ul_pool_get_size() <= 1 || num_rows < MIN_PARALLEL_ROWS || !prepare_extra_glyphs(bands)) {
+        return false;
+    }
+
+    ul_pool_run((size_t)(num_rows + BAND_ROWS - 1) / BAND_ROWS, draw_band_cb, bands);
+    return true;
+}
+
+static void draw_band_cb(size_t index, void *user_data) {
+    row_bands *bands = user_data;
+    const int first_row = bands->first_row + (int)index * BAND_ROWS;
+    const int last_row = LV_MIN(first_row + BAND_ROWS - 1, bands->last_row);
+
+    for (int row = first_row; row <= last_row; ++row) {
+        int length;
+        const ul_screen_cell *cells = get_view_row(bands->term, row, &length);
+        draw_row_cached(bands->term, bands->draw_ctx, bands->clip_area, row, cells, length, bands->first_col,
+            bands->last_col);
+    }
+}
+
+static bool prepare_extra_glyphs(row_bands *bands) {
+    uint32_t slots[UL_TERM_WIDGET_EXTRA_GLYPHS] = { 0 };
+
+    for (int row = bands->first_row; row <= bands->last_row; ++row) {
+        int length;
+        const ul_screen_cell *cells = get_view_row(bands->term, row, &length);
+        const int last_col = LV_MIN(bands->last_col, length - 1);
+        for (int col = bands->first_col; col <= last_col; ++col) {
+            const uint32_t codepoint = cells[col].codepoint;
+            if (codepoint <= UL_TERM_WIDGET_ATLAS_LAST) {
+                continue;
+            }
+
+            /* Two characters competing for a slot would evict each other while being drawn */
+            uint32_t *slot = &(slots[codepoint % UL_TERM_WIDGET_EXTRA_GLYPHS]);
+            if (*slot != 0 && *slot != codepoint) {
+                return false;
+            }
+            *slot = codepoint;
+            get_glyph(bands->term, codepoint);
+        }
+    }
+
+    return true;
+}
+
+static void draw_row_cached(ul_term_widget_t *term, lv_draw_ctx_t *draw_ctx, const lv_area_t *clip_area, int row,
+    const ul_screen_cell *cells, int length, int first_col, int last_col) {
+    const int cols = term->screen->cols;
+    const lv_coord_t x0 = term->obj.coords.x1;
+    const lv_coord_t y0 = term->obj.coords.y1 + row * term->cell_height;
+
+    /* Only rows that are drawn across the whole grid width are cached */
+    if (!ul_rowcache_is_enabled(&(term->row_cache)) || clip_area->x1 != x0
+        || clip_area->x2 != x0 + cols * term->cell_width - 1) {
+        draw_row(term, draw_ctx, clip_area, row, cells, length, first_col, last_col);
+        return;
+    }
+
+    /* Cells past the grid are never drawn. The colours are part of the key in case they are ever changed. */
+    length = LV_MIN(length, cols);
+    const uint64_t colors = ((uint64_t)term->default_fg.full << 32) ^ term->default_bg.full;
+    const uint64_t key = ul_rowcache_hash(cells, length, colors);
+
+    const lv_area_t *buf_area = draw_ctx->buf_area;
+    const size_t stride = (size_t)lv_area_get_width(buf_area) * sizeof(lv_color_t);
+    const size_t line_size = (size_t)cols * term->cell_width * sizeof(lv_color_t);
+    const lv_coord_t first_y = LV_MAX(y0, clip_area->y1);
+    const lv_coord_t last_y = LV_MIN(y0 + term->cell_height - 1, clip_area->y2);
+    lv_color_t *dst = (lv_color_t *)draw_ctx->buf + (first_y - buf_area->y1) * lv_area_get_width(buf_area)
+        + (x0 - buf_area->x1);
+
+    if (ul_rowcache_get(&(term->row_cache), key, cells, length, line_size, first_y - y0, last_y - y0, dst, stride)) {
+        return;
+    }
+
+    draw_row(term, draw_ctx, clip_area, row, cells, length, first_col, last_col);
+
+    /* Partly clipped rows cannot be stored */
+    if (first_y == y0 && last_y == y0 + term->cell_height - 1) {
+        ul_rowcache_put(&(term->row_cache), key, cells, length, line_size, term->cell_height, dst, stride);
+    }
+}
+
+static void draw_row(ul_term_widget_t *term, lv_draw_ctx_t *draw_ctx, const lv_area_t *clip_area, int row,
+    const ul_screen_cell *cells, int length, int first_col, int last_col) {
+    const lv_coord_t x0 = term->obj.coords.x1;
+    const lv_coord_t y0 = term->obj.coords.y1 + row * term->cell_height;
+
+    /* Columns past the end of a scrollback line are blank */
+    if (length <= last_col) {
+        lv_area_t blank = {
+            .x1 = LV_MAX(x0 + LV_MAX(length, first_col) * term->cell_width, clip_area->x1),
+            .y1 = LV_MAX(y0, clip_area->y1),
+            .x2 = clip_area->x2,
+            .y2 = LV_MIN(y0 + term->cell_height - 1, clip_area->y2)
+        };
+        fill_area(draw_ctx, &blank, term->default_bg);
+        last_col = length - 1;
+    }
+
+    int col = first_col;
+    while (col <= last_col) {
+        uint32_t attr = cells[col].attr;
+        const lv_opa_t *glyph = get_glyph(term, cells[col].codepoint);
+
+        lv_color_t fg, bg;
+        resolve_colors(term, attr, &fg, &bg);
+
+        if (glyph || (attr & UL_SCREEN_ATTR_UNDERLINE)) {
+            draw_cell(term, draw_ctx, clip_area, row, col, glyph, fg, bg, attr & UL_SCREEN_ATTR_UNDERLINE);
+            ++col;
+            continue;
+        }
+
+        /* Fill runs of blank cells with the same attributes in one go */
+        int first = col;
+        while (col + 1 <= last_col && cells[col + 1].attr == attr && !get_glyph(term, cells[col + 1].codepoint)) {
+            ++col;
+        }
+
+        lv_area_t run = {
+            .x1 = x0 + first * term->cell_width,
+            .y1 = y0,
+            .x2 = x0 + (col + 1) * term->cell_width - 1,
+            .y2 = y0 + term->cell_height - 1
+        };
+        lv_area_t area;
+        if (_lv_area_intersect(&area, &run, clip_area)) {
+            fill_area(draw_ctx, &area, bg);
+        }
+        ++col;
+    }
+}
+
+static bool move_rows(ul_term_widget_t *term, int top, int bottom, int lines) {
+    ul_screen *screen = term->screen;
+    const lv_area_t *coords = &(term->obj.coords);
+
+    lv_area_t area = {
+        .x1 = coords->x1,
+        .y1 = coords->y1 + top * term->cell_height,
+        .x2 = coords->x1 + screen->cols * term->cell_width - 1,
+        .y2 = coords->y1 + (bottom + 1) * term->cell_height - 1
+    };
+    if (lines != 0 && (!is_area_exposed(term, &area)
+        || !ul_display_move_area(lv_obj_get_disp(&(term->obj)), &area, -lines * term->cell_height))) {
+        return false;
+    }
+
+    /* Rows drawn after the previous invalidation and the cursor were carried along with the pixels */
+    int first = LV_MAX(term->drawn_first_row, top);
+    int last = LV_MIN(term->drawn_last_row, bottom);
+    for (int row = first; row <= last; ++row) {
+        if (row - lines >= top && row - lines <= bottom) {
+            ul_screen_mark_row_dirty(screen, row - lines);
+        }
+    }
+    const int cursor_row = term->drawn_cursor_row;
+    if (cursor_row >= top && cursor_row <= bottom && cursor_row - lines >= top && cursor_row - lines <= bottom) {
+        ul_screen_mark_row_dirty(screen, cursor_row - lines);
+    }
+    ul_screen_mark_row_dirty(screen, screen->cursor_row);
+
+    return true;
+}
+
+static bool is_area_exposed(ul_term_widget_t *term, const lv_area_t *area) {
+    lv_obj_t *obj = &(term->obj);
+
+    lv_area_t visible = *area;
+    if (!lv_obj_area_is_visible(obj, &visible) || visible.x1 != area->x1 || visible.y1 != area->y1
+        || visible.x2 != area->x2 || visible.y2 != area->y2) {
+        return false;
+    }
+
+    /* Siblings created later and the top layers are drawn over the widget */
+    lv_disp_t *disp = lv_obj_get_disp(obj);
+    lv_obj_t *parent = lv_obj_get_parent(obj);
+    return !(parent && is_covered_by_children(parent, lv_obj_get_index(obj) + 1, area))
+        && !is_covered_by_children(lv_disp_get_layer_top(disp), 0, area)
+        && !is_covered_by_children(lv_disp_get_layer_sys(disp), 0, area);
+}
+
+static bool is_covered_by_children(lv_obj_t *parent, uint32_t first_index, const lv_area_t *area) {
+    const uint32_t count = lv_obj_get_child_cnt(parent);
+    for (uint32_t i = first_index; i < count; ++i) {
+        lv_obj_t *child = lv_obj_get_child(parent, (int32_t)i);
+        if (!lv_obj_has_flag(child, LV_OBJ_FLAG_HIDDEN) && _lv_area_is_on(&(child->coords), area)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void draw_cursor(ul_term_widget_t *term, lv_draw_ctx_t *draw_ctx, const lv_area_t *clip_area) {
+    ul_screen *screen = term->screen;
+    int row = screen->cursor_row + (int)get_view_offset(term);
+    int col = screen->cursor_col;
+
+    term->drawn_cursor_row = row;
+
+    if (term->preedit_length > 0) {
+        /* Typed text is only sent to the shell on enter, show it in place until then */
+        for (int i = 0; i < term->preedit_length && col + i < screen->cols; ++i) {
+            bool is_cursor = i == term->preedit_pos;
+            draw_cell(term, draw_ctx, clip_area, row, col + i, get_glyph(term, (uint8_t)term->preedit[i]),
+                is_cursor ? term->default_bg : term->default_fg, is_cursor ? term->default_fg : term->default_bg,
+                !is_cursor);
+        }
+        if (term->preedit_pos >= term->preedit_length && col + term->preedit_pos < screen->cols) {
+            draw_cell(term, draw_ctx, clip_area, row, col + term->preedit_pos, NULL,
+                term->default_bg, term->default_fg, false);
+        }
+        return;
+    }
+
+    if (!screen->is_cursor_visible) {
+        return;
+    }
+
+    /* Block cursor: the cell under it with its colours swapped */
+    const ul_screen_cell *cell = &(ul_screen_get_row(screen, screen->cursor_row)[col]);
+    lv_color_t fg, bg;
+    resolve_colors(term, cell->attr, &fg, &bg);
+    draw_cell(term, draw_ctx, clip_area, row, col, get_glyph(term, cell->codepoint), bg, fg, false);
+}
+
+static void draw_cell(ul_term_widget_t *term, lv_draw_ctx_t *draw_ctx, const lv_area_t *clip_area, int row, int col,
+    const lv_opa_t *glyph, lv_color_t fg, lv_color_t bg, bool is_underlined) {
+    lv_area_t cell = {
+        .x1 = term->obj.coords.x1 + col * term->cell_width,
+        .y1 = term->obj.coords.y1 + row * term->cell_height,
+    };
+    cell.x2 = cell.x1 + term->cell_width - 1;
+    cell.y2 = cell.y1 + term->cell_height - 1;
+
+    lv_area_t area;
+    if (!_lv_area_intersect(&area, &cell, clip_area)) {
+        return;
+    }
+
+    const lv_area_t *buf_area = draw_ctx->buf_area;
+    const lv_coord_t stride = lv_area_get_width(buf_area);
+    const lv_coord_t width = lv_area_get_width(&area);
+    const lv_coord_t underline_y = cell.y2 - 1;
+
+    for (lv_coord_t y = area.y1; y <= area.y2; ++y) {
+        lv_color_t *dst = (lv_color_t *)draw_ctx->buf + (y - buf_area->y1) * stride + (area.x1 - buf_area->x1);
+
+        if (is_underlined && y == underline_y) {
+            lv_color_fill(dst, fg, width);
+            continue;
+        }
+        if (!glyph) {
+            lv_color_fill(dst, bg, width);
+            continue;
+        }
+
+        /* Bitmap fonts need no blending, every pixel is either text or background */
+        const uint32_t *bits = get_glyph_bits(term, glyph);
+        if (bits) {
+            expand_bits(dst, bits[y - cell.y1] << (area.x1 - cell.x1), width, fg, bg);
+            continue;
+        }
+
+        const lv_opa_t *src = glyph + (y - cell.y1) * term->cell_width + (area.x1 - cell.x1);
+        lv_color_fill(dst, bg, width);
+        ul_blend_mask_solid(dst, src, fg, width);
+    }
+}
+
+static void expand_bits(lv_color_t *dst, uint32_t bits, lv_coord_t width, lv_color_t fg, lv_color_t bg) {
+    const uint32_t diff = fg.full ^ bg.full;
+
+    lv_coord_t x = 0;
+    for (; x + 4 <= width; x += 4) {
+        const uint32_t *masks = nibble_masks[bits >> 28];
+        dst[x].full = bg.full ^ (diff & masks[0]);
+        dst[x + 1].full = bg.full ^ (diff & masks[1]);
+        dst[x + 2].full = bg.full ^ (diff & masks[2]);
+        dst[x + 3].full = bg.full ^ (diff & masks[3]);
+        bits <<= 4;
+    }
+    for (; x < width; ++x) {
+        dst[x] = (bits & 0x80000000u) ? fg : bg;
+        bits <<= 1;
+    }
+}
+
+static void fill_area(lv_draw_ctx_t *draw_ctx, const lv_area_t *area, lv_color_t color) {
+    const lv_area_t *buf_area = draw_ctx->buf_area;
+    const lv_coord_t stride = lv_area_get_width(buf_area);
+    const lv_coord_t width = lv_area_get_width(area);
+
+    lv_color_t *dst = (lv_color_t *)draw_ctx->buf + (area->y1 - buf_area->y1) * stride + (area->x1 - buf_area->x1);
+    for (lv_coord_t y = area->y1; y <= area->y2; ++y) {
+        lv_color_fill(dst, color, width);
+        dst += stride;
+    }
+}
+
+static const ul_screen_cell *get_view_row(const ul_term_widget_t *term, int row, int *length) {
+    const ul_screen *screen = term->screen;
+    const size_t offset = get_view_offset(term);
+
+    if ((size_t)row < offset) {
+        size_t index = screen->scrollback.count - offset + row;
+        return ul_scrollback_get_line(&(screen->scrollback), index, length);
+    }
+
+    *length = screen->cols;
+    return ul_screen_get_row(screen, row - (int)offset);
+}
+
+static size_t get_view_offset(const ul_term_widget_t *term) {
+    const ul_scrollback *scrollback = &(term->screen->scrollback);
+    size_t offset = term->view_offset;
+    if (offset > 0) {
+        offset += (size_t)(scrollback->pushed - term->view_pushed);
+    }
+    return LV_MIN(offset, scrollback->count);
+}
+
+static void anchor_view(ul_term_widget_t *term) {
+    term->view_offset = get_view_offset(term);
+    term->view_pushed = term->screen->scrollback.pushed;
+}
+
+static void scroll_view(ul_term_widget_t *term, int lines) {
+    if (!term->screen || lines == 0) {
+        return;
+    }
+
+    anchor_view(term);
+
+    size_t max_offset = term->screen->is_alternate ? 0 : term->screen->scrollback.count;
+    size_t offset = term->view_offset;
+    if (lines < 0) {
+        offset = (size_t)-lines > offset ? 0 : offset + lines;
+    } else {
+        offset = LV_MIN(offset + lines, max_offset);
+    }
+
+    if (offset != term->view_offset) {
+        term->view_offset = offset;
+        lv_obj_invalidate(&(term->obj));
+    }
+}
+
+static const lv_opa_t *get_glyph(ul_term_widget_t *term, uint32_t codepoint) {
+    if (codepoint <= ' ') {
+        return NULL;
+    }
+
+    const size_t glyph_size = (size_t)term->cell_width * term->cell_height;
+    const lv_opa_t *fallback = term->atlas + (size_t)('?' - UL_TERM_WIDGET_ATLAS_FIRST) * glyph_size;
+    if (codepoint <= UL_TERM_WIDGET_ATLAS_LAST) {
+        return term->atlas + (size_t)(codepoint - UL_TERM_WIDGET_ATLAS_FIRST) * glyph_size;
+    }
+    if (!term->extra_glyphs) {
+        return fallback;
+    }
+
+    size_t slot = codepoint % UL_TERM_WIDGET_EXTRA_GLYPHS;
+    lv_opa_t *glyph = term->extra_glyphs + slot * glyph_size;
+    if (term->extra_codepoints[slot] != codepoint) {
+        memset(glyph, 0, glyph_size);
+        if (!rasterize_glyph(term->font, codepoint, glyph, term->cell_width, term->cell_height)) {
+            /* Not covered by the font */
+            memcpy(glyph, fallback, glyph_size);
+        }
+        if (term->extra_bits) {
+            pack_glyph_bits(glyph, term->extra_bits + slot * term->cell_height, term->cell_width, term->cell_height);
+        }
+        term->extra_codepoints[slot] = codepoint;
+    }
+    return glyph;
+}
+
+static const uint32_t *get_glyph_bits(const ul_term_widget_t *term, const lv_opa_t *glyph) {
+    if (!term->atlas_bits) {
+        return NULL;
+    }
+
+    const size_t glyph_size = (size_t)term->cell_width * term->cell_height;
+    if (glyph >= term->atlas && glyph < term->atlas + ATLAS_SIZE * glyph_size) {
+        return term->atlas_bits + (size_t)(glyph - term->atlas) / glyph_size * term->cell_height;
+    }
+    if (term->extra_bits && glyph >= term->extra_glyphs
+        && glyph < term->extra_glyphs + UL_TERM_WIDGET_EXTRA_GLYPHS * glyph_size) {
+        return term->extra_bits + (size_t)(glyph - term->extra_glyphs) / glyph_size * term->cell_height;
+    }
+    return NULL;
+}
+
+static void pack_glyph_bits(const lv_opa_t *glyph, uint32_t *bits, lv_coord_t cell_width, lv_coord_t cell_height) {
+    for (lv_coord_t y = 0; y < cell_height; ++y) {
+        uint32_t row = 0;
+        for (lv_coord_t x = 0; x < cell_width; ++x) {
+            if (glyph[y * cell_width + x] >= LV_OPA_50) {
+                row |= 0x80000000u >> x;
+            }
+        }
+        bits[y] = row;
+    }
+}
+
+static void resolve_colors(const ul_term_widget_t *term, uint32_t attr, lv_color_t *fg, lv_color_t *bg) {
+    uint8_t fg_index = UL_SCREEN_ATTR_FG(attr);
+    if ((attr & UL_SCREEN_ATTR_BOLD) && fg_index < 8) {
+        /* There is no bold font, use the bright colours instead */
+        fg_index += 8;
+    }
+
+    *fg = (attr & UL_SCREEN_ATTR_DEFAULT_FG) ? term->default_fg : term->palette[fg_index];
+    *bg = (attr & UL_SCREEN_ATTR_DEFAULT_BG) ? term->default_bg : term->palette[UL_SCREEN_ATTR_BG(attr)];
+
+    if (attr & UL_SCREEN_ATTR_REVERSE) {
+        lv_color_t tmp = *fg;
+        *fg = *bg;
+        *bg = tmp;
+    }
+}
+
+static bool rasterize_glyph(const lv_font_t *font, uint32_t codepoint, lv_opa_t *glyph, lv_coord_t cell_width,
+    lv_coord_t cell_height) {
+    lv_font_glyph_dsc_t dsc;
+    if (!lv_font_get_glyph_dsc(font, &dsc, codepoint, 0)) {
+        return false;
+    }
+
+    const uint8_t *bitmap = lv_font_get_glyph_bitmap(font, codepoint);
+    if (!bitmap || (dsc.bpp != 1 && dsc.bpp != 2 && dsc.bpp != 4 && dsc.bpp != 8)) {
+        return false;
+    }
+
+    /* Place the glyph box relative to the baseline, like the label renderer does */
+    const int x0 = dsc.ofs_x;
+    const int y0 = cell_height - font->base_line - dsc.box_h - dsc.ofs_y;
+    const unsigned int max_value = (1u << dsc.bpp) - 1;
+
+    for (int y = 0; y < dsc.box_h; ++y) {
+        for (int x = 0; x < dsc.box_w; ++x) {
+            int cell_x = x0 + x;
+            int cell_y = y0 + y;
+            if (cell_x < 0 || cell_x >= cell_width || cell_y < 0 || cell_y >= cell_height) {
+                continue;
+            }
+
+            /* Bitmaps are packed MSB first without row padding */
+            size_t bit = ((size_t)y * dsc.box_w + x) * dsc.bpp;
+            unsigned int value = (bitmap[bit >> 3] >> (8 - dsc.bpp - (bit & 7))) & max_value;
+            glyph[cell_y * cell_width + cell_x] = (lv_opa_t)(value * 255 / max_value);
+        }
+    }
+
+    return true;
+}
+
+static lv_opa_t *build_atlas(const lv_font_t *font, lv_coord_t cell_width, lv_coord_t cell_height) {
+    const size_t glyph_size = (size_t)cell_width * cell_height;
+    lv_opa_t *atlas = calloc(ATLAS_SIZE, glyph_size);
+    if (!atlas) {
+        return NULL;
+    }
+
+    for (uint32_t codepoint = UL_TERM_WIDGET_ATLAS_FIRST; codepoint <= UL_TERM_WIDGET_ATLAS_LAST; ++codepoint) {
+        rasterize_glyph(font, codepoint, atlas + (codepoint - UL_TERM_WIDGET_ATLAS_FIRST) * glyph_size, cell_width,
+            cell_height);
+    }
+
+    return atlas;
+}
+
+
+/**
+ * Public functions
+ */
+
+lv_obj_t *ul_term_widget_create(lv_obj_t *parent) {
+    lv_obj_t *obj = lv_obj_class_create_obj(MY_CLASS, parent);
+    lv_obj_class_init_obj(obj);
+    /* All drawing is done by the widget itself */
+    lv_obj_remove_style_all(obj);
+    return obj;
+}
+
+void ul_term_widget_set_font(lv_obj_t *obj, const lv_font_t *font) {
+    ul_term_widget_t *term = (ul_term_widget_t *)obj;
+
+    lv_coord_t cell_width = lv_font_get_glyph_width(font, 'M', 0);
+    lv_coord_t cell_height = lv_font_get_line_height(font);
+    lv_opa_t *atlas = build_atlas(font, cell_width, cell_height);
+    if (!atlas) {
+        ul_log(UL_LOG_LEVEL_ERROR, "Could not allocate the terminal glyph atlas");
+        return;
+    }
+
+    free(term->atlas);
+    term->atlas = atlas;
+    term->font = font;
+    term->cell_width = cell_width;
+    term->cell_height = cell_height;
+
+    /* Characters outside the atlas are rasterised when they are first drawn. Without the cache they show as '?'. */
+    free(term->extra_glyphs);
+    term->extra_glyphs = calloc(UL_TERM_WIDGET_EXTRA_GLYPHS, (size_t)cell_width * cell_height);
+    memset(term->extra_codepoints, 0, sizeof(term->extra_codepoints));
+
+    /* Bitmap fonts are drawn from packed bits, without any blending */
+    free(term->atlas_bits);
+    term->atlas_bits = NULL;
+    free(term->extra_bits);
+    term->extra_bits = NULL;
+    lv_font_glyph_dsc_t dsc;
+    if (lv_font_get_glyph_dsc(font, &dsc, 'M', 0) && dsc.bpp == 1 && cell_width <= MAX_BITS_CELL_WIDTH) {
+        const size_t glyph_size = (size_t)cell_width * cell_height;
+        term->atlas_bits = malloc(ATLAS_SIZE * cell_height * sizeof(uint32_t));
+        term->extra_bits = calloc(UL_TERM_WIDGET_EXTRA_GLYPHS * cell_height, sizeof(uint32_t));
+        if (!term->atlas_bits || !term->extra_bits) {
+            free(term->atlas_bits);
+            term->atlas_bits = NULL;
+            free(term->extra_bits);
+            term->extra_bits = NULL;
+        } else {
+            for (size_t i = 0; i < ATLAS_SIZE; ++i) {
+                pack_glyph_bits(atlas + i * glyph_size, term->atlas_bits + i * cell_height, cell_width, cell_height);
+            }
+        }
+    }
+
+    /* Rows drawn with the old font */
+    ul_rowcache_clear(&(term->row_cache));
+
+    lv_obj_invalidate(obj);
+}
+
+void ul_term_widget_get_cell_size(lv_obj_t *obj, lv_coord_t *width, lv_coord_t *height) {
+    ul_term_widget_t *term = (ul_term_widget_t *)obj;
+    *width = term->cell_width;
+    *height = term->cell_height;
+}
+
+void ul_term_widget_set_screen(lv_obj_t *obj, ul_screen *screen) {
+    ul_term_widget_t *term = (ul_term_widget_t *)obj;
+    term->screen = screen;
+    term->view_offset = 0;
+    term->view_pushed = screen->scrollback.pushed;
+    lv_obj_invalidate(obj);
+}
+
+void ul_term_widget_set_preedit(lv_obj_t *obj, const char *text, int length, int pos) {
+    ul_term_widget_t *term = (ul_term_widget_t *)obj;
+
+    term->preedit = text;
+    term->preedit_length = length;
+    term->preedit_pos = pos;
+
+    if (!term->screen) {
+        return;
+    }
+
+    /* Typing jumps back to the live screen */
+    ul_screen_lock(term->screen);
+    scroll_view(term, -(int)term->view_offset);
+    ul_screen_mark_row_dirty(term->screen, term->screen->cursor_row);
+    ul_screen_unlock(term->screen);
+
+    ul_term_widget_invalidate_dirty_rows(obj);
+}
+
+void ul_term_widget_set_row_cache_size(lv_obj_t *obj, size_t max_size) {
+    ul_term_widget_t *term = (ul_term_widget_t *)obj;
+    ul_rowcache_set_max_size(&(term->row_cache), max_size);
+}
+
+void ul_term_widget_get_row_cache_stats(lv_obj_t *obj, uint64_t *hits, uint64_t *misses) {
+    ul_term_widget_t *term = (ul_term_widget_t *)obj;
+    ul_rowcache_get_stats(&(term->row_cache), hits, misses);
+}
+
+void ul_term_widget_invalidate_dirty_rows(lv_obj_t *obj) {
+    ul_term_widget_t *term = (ul_term_widget_t *)obj;
+    ul_screen *screen = term->screen;
+    if (!screen) {
+        return;
+    }
+
+    const lv_area_t *coords = &(term->obj.coords);
+
+    ul_screen_lock(screen);
+
+    /* A view that is scrolled back keeps showing the same history, only typing or dragging moves it */
+    anchor_view(term);
+
+    /* Rows are shifted while looking at the scrollback, so there is no point in tracking them individually */
+    if (term->view_offset > 0) {
+        if (screen->is_alternate) {
+            term->view_offset = 0;
+        }
+        lv_obj_invalidate(obj);
+        ul_screen_clear_dirty(screen);
+        term->drawn_first_row = INT_MAX;
+        term->drawn_last_row = -1;
+        ul_screen_unlock(screen);
+        return;
+    }
+
+    /* Scrolled rows keep their pixels if they can be moved along, otherwise the whole region is redrawn */
+    int top, bottom, lines;
+    if (ul_screen_get_move(screen, &top, &bottom, &lines) && !move_rows(term, top, bottom, lines)) {
+        for (int row = top; row <= bottom; ++row) {
+            ul_screen_mark_row_dirty(screen, row);
+        }
+    }
+
+    /* Merge runs of adjacent dirty rows into one area */
+    int row = 0;
+    while (row < screen->rows) {
+        if (!ul_screen_is_row_dirty(screen, row)) {
+            ++row;
+            continue;
+        }
+
+        int first = row;
+        while (row < screen->rows && ul_screen_is_row_dirty(screen, row)) {
+            ++row;
+        }
+
+        lv_area_t area = {
+            .x1 = coords->x1,
+            .y1 = coords->y1 + first * term->cell_height,
+            .x2 = coords->x2,
+            .y2 = coords->y1 + row * term->cell_height - 1
+        };
+        lv_obj_invalidate_area(obj, &area);
+    }
+
+    ul_screen_clear_dirty(screen);
+    term->drawn_first_row = INT_MAX;
+    term->drawn_last_row = -1;
+    ul_screen_unlock(screen);
+}
@@ -0,0 +1,147 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_TERM_WIDGET_H
+#define UL_TERM_WIDGET_H
+
+#include "rowcache.h"
+#include "screen.h"
+
+#include "lvgl/lvgl.h"
+
+/* First and last character kept in the glyph atlas */
+#define UL_TERM_WIDGET_ATLAS_FIRST 0x20
+#define UL_TERM_WIDGET_ATLAS_LAST 0x7e
+/* Number of characters outside the atlas that are kept rasterised */
+#define UL_TERM_WIDGET_EXTRA_GLYPHS 64
+
+/* Monospace terminal widget that draws a ul_screen cell by cell from a pre-rasterised glyph atlas */
+typedef struct {
+    lv_obj_t obj;
+    /* Screen to draw, not owned */
+    ul_screen *screen;
+    /* Font the atlas was built from */
+    const lv_font_t *font;
+    lv_coord_t cell_width;
+    lv_coord_t cell_height;
+    /* Opacity maps of cell_width * cell_height pixels for every character in the atlas */
+    lv_opa_t *atlas;
+    /* Recently drawn characters outside the atlas, one slot per codepoint modulo UL_TERM_WIDGET_EXTRA_GLYPHS */
+    uint32_t extra_codepoints[UL_TERM_WIDGET_EXTRA_GLYPHS];
+    lv_opa_t *extra_glyphs;
+    /* For 1 bpp fonts, the atlas and extra glyphs again as one word per glyph row, leftmost pixel in the highest bit.
+     * NULL for anti-aliased fonts. */
+    uint32_t *atlas_bits;
+    uint32_t *extra_bits;
+    /* Colours */
+    lv_color_t default_fg;
+    lv_color_t default_bg;
+    lv_color_t palette[256];
+    /* Text that is being typed but not sent yet, drawn at the cursor. Not owned. */
+    const char *preedit;
+    int preedit_length;
+    int preedit_pos;
+    /* Number of scrollback lines the view is scrolled up by, 0 shows the live screen */
+    size_t view_offset;
+    /* Scrollback push count at which view_offset was last updated */
+    uint64_t view_pushed;
+    /* Vertical drag distance not yet converted into whole lines */
+    lv_coord_t drag_remainder;
+    /* Rows drawn since the dirty rows were last invalidated (none if first > last). When the screen scrolls they
+     * already show newer content than the rows whose pixels are moved along, so they are redrawn instead. */
+    int drawn_first_row;
+    int drawn_last_row;
+    /* Row the cursor was last drawn in, -1 if it was not drawn yet */
+    int drawn_cursor_row;
+    /* Pixels of recently drawn rows, reused when the same content is shown again */
+    ul_rowcache row_cache;
+} ul_term_widget_t;
+
+extern const lv_obj_class_t ul_term_widget_class;
+
+/**
+ * Create a terminal widget.
+ *
+ * @param parent parent object
+ * @return the new widget
+ */
+lv_obj_t *ul_term_widget_create(lv_obj_t *parent);
+
+/**
+ * Set the font and rebuild the glyph atlas. The font must be monospaced.
+ *
+ * @param obj terminal widget
+ * @param font font to use
+ */
+void ul_term_widget_set_font(lv_obj_t *obj, const lv_font_t *font);
+
+/**
+ * Get the size of one character cell of the current font.
+ *
+ * @param obj terminal widget
+ * @param width pointer for writing the cell width in pixels
+ * @param height pointer for writing the cell height in pixels
+ */
+void ul_term_widget_get_cell_size(lv_obj_t *obj, lv_coord_t *width, lv_coord_t *height);
+
+/**
+ * Set the screen to draw. The widget takes the screen's lock whenever it reads or changes it, so callers must
+ * not hold it while calling into the widget.
+ *
+ * @param obj terminal widget
+ * @param screen screen, must outlive the widget
+ */
+void ul_term_widget_set_screen(lv_obj_t *obj, ul_screen *screen);
+
+/**
+ * Set the text that is being typed but has not been sent to the shell yet.
+ *
+ * @param obj terminal widget
+ * @param text text (not copied, must stay valid until the next call)
+ * @param length length of the text
+ * @param pos cursor position within the text
+ */
+void ul_term_widget_set_preedit(lv_obj_t *obj, const char *text, int length, int pos);
+
+/**
+ * Set the memory cap of the cache of rendered rows.
+ *
+ * @param obj terminal widget
+ * @param max_size maximum number of bytes to use, 0 to disable the cache
+ */
+void ul_term_widget_set_row_cache_size(lv_obj_t *obj, size_t max_size);
+
+/**
+ * Get the lookup statistics of the cache of rendered rows.
+ *
+ * @param obj terminal widget
+ * @param hits pointer for writing the number of rows copied from the cache
+ * @param misses pointer for writing the number of rows that had to be drawn
+ */
+void ul_term_widget_get_row_cache_stats(lv_obj_t *obj, uint64_t *hits, uint64_t *misses);
+
+/**
+ * Invalidate the rows that changed on the screen since the last call and clear the screen's dirty state.
+ *
+ * @param obj terminal widget
+ */
+void ul_term_widget_invalidate_dirty_rows(lv_obj_t *obj);
+
+#endif /* UL_TERM_WIDGET_H */
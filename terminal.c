@@ -22,39 +22,61 @@
 #include "terminal.h"
 
 #include "log.h"
+#include "ring.h"
 
 #include "lvgl/src/widgets/keyboard/lv_keyboard_global.h"
 
-#include "termstr.h"
-
 #include <fcntl.h>
 #include <stdbool.h>
 #include <unistd.h>
 
 #include <linux/kd.h>
 
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/ioctl.h>
+#include <sys/signalfd.h>
+#include <errno.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <poll.h>
 #include <pthread.h>
 #include <pty.h>
 #include <signal.h>
 #include <termios.h>
 
+/**
+ * Defines
+ */
+
+#define OUTPUT_RING_SIZE (4 * 1024 * 1024)
+#define INPUT_RING_SIZE (64 * 1024)
+#define MAX_EVENTS 4
+
+
 /**
  * Static variables
  */
 
 static char terminal_buffer[BUFFER_SIZE];
 
+static ul_ring output_ring;
+static ul_ring input_ring;
+
 static int pid = 0;
 static int sig_int_pid = -1;
 static int tty_fd = 0;
 
-bool term_needs_update = false;
+static pthread_t tty_id;
+static int epoll_fd = -1;
+static int wake_fd = -1;
+/* Signalled by the TTY thread whenever it added output to the ring */
+static int output_fd = -1;
+static int signal_fd = -1;
+static sigset_t forwarded_signals;
 
-pthread_mutex_t tty_mutex;
+/* Set by the TTY thread when it stopped reading because the output ring was full */
+static atomic_bool output_stalled = false;
 
 /**
  * Static prototypes
@@ -62,14 +84,38 @@ pthread_mutex_t tty_mutex;
 
 static void* tty_thread(void* arg);
 
+/**
+ * Read one chunk of shell output and queue it for the UI.
+ *
+ * @return false if the shell has gone away, true otherwise
+ */
+static bool handle_tty_readable(void);
+
+/**
+ * Write queued keyboard input to the shell.
+ */
+static void handle_pending_input(void);
+
+/**
+ * Forward interrupt / suspend requests read from the signalfd to the shell.
+ */
+static void handle_signals(void);
+
+/**
+ * Enable or disable read notifications for the PTY master.
+ *
+ * @param enabled true to wake up on shell output, false to ignore it
+ */
+static void set_tty_readable_events(bool enabled);
+
 static void run_kill_child_pids(int signal);
 
 static void clean_command_buffer();
 
 typedef struct term_dimen
 {
-    int width;
-    int height;
+    int cols;
+    int rows;
 } term_dimen;
 
 /**
@@ -98,11 +144,57 @@ static void clean_command_buffer() {
         command_buffer[i] = '\0';
 }
 
-void disable_echo(int fd) {
-    struct termios term;
-    tcgetattr(fd, &term);
-    term.c_lflag &= ~ECHO;
-    tcsetattr(fd, TCSANOW, &term);
+static bool handle_tty_readable(void) {
+    ssize_t length = read(tty_fd, terminal_buffer, sizeof(terminal_buffer));
+    if (length <= 0)
+        return length < 0 && (errno == EINTR || errno == EAGAIN);
+
+    ul_ring_write(&output_ring, terminal_buffer, length);
+    eventfd_write(output_fd, 1);
+    return true;
+}
+
+static void handle_pending_input(void) {
+    char command[BUFFER_SIZE];
+    size_t length;
+
+    while ((length = ul_ring_read(&input_ring, command, sizeof(command) - 1)) > 0) {
+        command[length] = '\0';
+
+        char first_word[5] = "";
+        sscanf(command, "%4s", first_word);
+        if (strcmp(first_word, "exit") == 0) {
+            run_kill_child_pids(SIGTERM);
+            kill(pid, SIGTERM);
+            close(tty_fd);
+            exit(0);
+        }
+
+        size_t written = 0;
+        while (written < length) {
+            ssize_t n = write(tty_fd, command + written, length - written);
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                break;
+            }
+            written += n;
+        }
+    }
+}
+
+static void handle_signals(void) {
+    struct signalfd_siginfo info;
+
+    while (read(signal_fd, &info, sizeof(info)) == sizeof(info)) {
+        run_kill_child_pids(info.ssi_signo);
+        kill(pid, info.ssi_signo);
+    }
+}
+
+static void set_tty_readable_events(bool enabled) {
+    struct epoll_event event = { .events = enabled ? EPOLLIN : 0, .data.fd = tty_fd };
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, tty_fd, &event);
 }
 
 static void* tty_thread(void* arg)
@@ -110,17 +202,15 @@ static void* tty_thread(void* arg)
     struct winsize ws = {0};
     struct term_dimen *tty_dimen = (struct term_dimen*)arg;
 
-    ws.ws_col = tty_dimen->width / 8; //max width of font_32
-    ws.ws_row = tty_dimen->height / 16; //max height of font_32
+    ws.ws_col = tty_dimen->cols;
+    ws.ws_row = tty_dimen->rows;
     pid = forkpty(&tty_fd, NULL, NULL, &ws);
     if (sig_int_pid < 0)
         sig_int_pid = pid;
 
-    char* entered_command = NULL;
-    char* cut_terminal = NULL;
-    int tmp_length = 0;
-
     if (pid == 0) {
+        /* The shell must not inherit the signal mask used for forwarding */
+        sigprocmask(SIG_UNBLOCK, &forwarded_signals, NULL);
         putenv("TERM=xterm");
         char* shell = getenv("SHELL");
         if (shell == NULL) {
@@ -128,88 +218,56 @@ static void* tty_thread(void* arg)
         }
         char* args[] = { shell, "-l", "-i", NULL };
         execvp(args[0], args);
-    } else {
-        char* shell = getenv("SHELL");
-        if (shell != NULL && strlen(shell) > 0) {
-            disable_echo(tty_fd);
-        }
-
-        struct pollfd p[2] = { { tty_fd, POLLIN | POLLOUT, 0 } };
-        while (1) {
-            pthread_mutex_lock(&tty_mutex);
-            poll(p, 2, 10);
-
-            usleep(100);
+        _exit(EXIT_FAILURE);
+    }
 
-            if (sig_int_sent) {
-                run_kill_child_pids(SIGINT);
-                kill(pid, SIGINT);
-                sig_int_sent = false;
-                clean_command_buffer();
-            }
-            if (sig_tstp_sent) {
-                run_kill_child_pids(SIGTSTP);
-                kill(pid, SIGTSTP);
-                sig_tstp_sent = false;
-                clean_command_buffer();
-            }
+    struct epoll_event event = { .events = EPOLLIN, .data.fd = tty_fd };
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, tty_fd, &event);
 
-            if ((p[0].revents & POLLIN) && !term_needs_update) {
-                int readValue = read(tty_fd, &terminal_buffer, BUFFER_SIZE);
-                terminal_buffer[readValue] = '\0';
+    bool tty_readable_events = true;
+    struct epoll_event events[MAX_EVENTS];
 
-                if (tmp_length != 0) {
-                    cut_terminal = (char*)malloc(tmp_length);
-                    memcpy(cut_terminal, terminal_buffer, tmp_length);
-                    cut_terminal[tmp_length] = '\0';
-                }
+    while (1) {
+        /* Sleep until the shell writes something, input is queued or a signal has to be forwarded */
+        int num_events = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+        if (num_events < 0) {
+            if (errno == EINTR)
+                continue;
+            ul_log(UL_LOG_LEVEL_ERROR, "Waiting for TTY events failed: %s", strerror(errno));
+            break;
+        }
 
-                if (entered_command == NULL || cut_terminal == NULL || strlen(entered_command) == 0 || strcmp(entered_command,cut_terminal) != 0)
-                    term_needs_update = true;
-                else if (strcmp(entered_command, cut_terminal) == 0) {
-                    remove_escape_codes(terminal_buffer);
-                    for (size_t i = 0; i < strlen(terminal_buffer) - 1; i++)
-                    {
-                        if (terminal_buffer[i] == 0x5e && terminal_buffer[i + 1] == 0x40)
-                        {
-                            terminal_buffer[i] = '\n';
-                            terminal_buffer[i+1] = '\n';
-                        }
+        for (int i = 0; i < num_events; ++i) {
+            int fd = events[i].data.fd;
+
+            if (fd == signal_fd) {
+                handle_signals();
+            } else if (fd == wake_fd) {
+                eventfd_t value;
+                eventfd_read(wake_fd, &value);
+                handle_pending_input();
+            } else if (fd == tty_fd) {
+                /* Keep draining the PTY for as long as the consumer has room for another full read */
+                if (ul_ring_writable(&output_ring) < BUFFER_SIZE) {
+                    atomic_store(&output_stalled, true);
+                    if (ul_ring_writable(&output_ring) < BUFFER_SIZE) {
+                        set_tty_readable_events(false);
+                        tty_readable_events = false;
+                        continue;
                     }
-                    int copy_size = strlen(terminal_buffer) - strlen(entered_command);
-                    if (copy_size-2 > 0){
-                        memcpy(terminal_buffer,terminal_buffer+strlen(entered_command), copy_size);
-                        terminal_buffer[copy_size] = 0;
-                        term_needs_update = true;
-                    }
-                }
-                if ((entered_command != NULL) && (strlen(entered_command) > 0)) {
-                    free(entered_command);
-                    entered_command = NULL;
-                }
-                if (cut_terminal != NULL) {
-                    free(cut_terminal);
-                    cut_terminal = NULL;
+                    atomic_store(&output_stalled, false);
                 }
-            }
-            else if ((p[0].revents & POLLOUT) && command_ready_to_send) {
-                char first_word[5];
-                sscanf(command_buffer, "%4s", first_word);
-                if (strcmp(first_word, "exit") == 0) {
-                    run_kill_child_pids(SIGTERM);
-                    kill(pid, SIGTERM);
+                if (!handle_tty_readable()) {
+                    /* The shell has exited */
                     close(tty_fd);
-                    pthread_mutex_unlock(&tty_mutex);
                     exit(0);
                 }
-
-                write(tty_fd, command_buffer, strlen(command_buffer));
-                command_ready_to_send = false;
-                entered_command = strdup(command_buffer);
-                tmp_length = strlen(command_buffer);
-                clean_command_buffer();
             }
-            pthread_mutex_unlock(&tty_mutex);
+        }
+
+        if (!tty_readable_events && ul_ring_writable(&output_ring) >= BUFFER_SIZE) {
+            set_tty_readable_events(true);
+            tty_readable_events = true;
         }
     }
 
@@ -221,14 +279,40 @@ static void* tty_thread(void* arg)
  * Public functions
  */
 
-bool ul_terminal_prepare_current_terminal(int term_width, int term_height) {
+void ul_terminal_block_forwarded_signals(void) {
+    sigemptyset(&forwarded_signals);
+    sigaddset(&forwarded_signals, SIGINT);
+    sigaddset(&forwarded_signals, SIGTSTP);
+    pthread_sigmask(SIG_BLOCK, &forwarded_signals, NULL);
+}
+
+bool ul_terminal_prepare_current_terminal(int term_cols, int term_rows) {
 
-    pthread_t tty_id;
+    static struct term_dimen dimen;
 
-    struct term_dimen dimen;
+    dimen.cols = term_cols;
+    dimen.rows = term_rows;
 
-    dimen.width = term_width;
-    dimen.height = term_height;
+    if (!ul_ring_init(&output_ring, OUTPUT_RING_SIZE) || !ul_ring_init(&input_ring, INPUT_RING_SIZE)) {
+        ul_log(UL_LOG_LEVEL_WARNING, "Could not allocate TTY buffers");
+        return false;
+    }
+
+    /* Interrupt and suspend requests were blocked in every thread by ul_terminal_block_forwarded_signals and are
+     * delivered to the TTY thread through a signalfd */
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    output_fd = eventfd(0, EFD_CLOEXEC);
+    signal_fd = signalfd(-1, &forwarded_signals, SFD_CLOEXEC | SFD_NONBLOCK);
+    if (epoll_fd < 0 || wake_fd < 0 || output_fd < 0 || signal_fd < 0) {
+        ul_log(UL_LOG_LEVEL_WARNING, "Could not set up TTY event handling");
+        return false;
+    }
+
+    struct epoll_event event = { .events = EPOLLIN, .data.fd = wake_fd };
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &event);
+    event.data.fd = signal_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, signal_fd, &event);
 
     if (pthread_create(&tty_id, NULL, tty_thread, (void*)&dimen) != 0) {
         ul_log(UL_LOG_LEVEL_WARNING, "Could not start TTY thread");
@@ -238,7 +322,41 @@ bool ul_terminal_prepare_current_terminal(int term_width, int term_height) {
     return true;
 }
 
-char* ul_terminal_update_interpret_buffer()
+int ul_terminal_get_output_fd(void)
 {
-    return (char*) &terminal_buffer;
+    return output_fd;
+}
+
+size_t ul_terminal_read_output(char *buffer, size_t length)
+{
+    size_t read_length = ul_ring_read(&output_ring, buffer, length);
+
+    /* Resume the TTY thread if it paused because we were not keeping up */
+    if (read_length > 0 && atomic_exchange(&output_stalled, false))
+        eventfd_write(wake_fd, 1);
+
+    return read_length;
+}
+
+void ul_terminal_process_keyboard_requests(void)
+{
+    if (wake_fd < 0)
+        return;
+
+    if (sig_int_sent) {
+        sig_int_sent = false;
+        clean_command_buffer();
+        pthread_kill(tty_id, SIGINT);
+    }
+    if (sig_tstp_sent) {
+        sig_tstp_sent = false;
+        clean_command_buffer();
+        pthread_kill(tty_id, SIGTSTP);
+    }
+    if (command_ready_to_send) {
+        command_ready_to_send = false;
+        ul_ring_write(&input_ring, command_buffer, strlen(command_buffer));
+        clean_command_buffer();
+        eventfd_write(wake_fd, 1);
+    }
 }
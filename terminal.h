@@ -33,9 +33,20 @@
 #define BUFFER_SIZE 4096
 
 /**
- * Prepare the current TTY for graphics output.
+ * Block the interrupt and suspend signals that are forwarded to the shell, so that they queue up for the TTY thread
+ * instead of interrupting an arbitrary thread. Must be called before any thread is started, which then inherits the
+ * mask, and before ul_terminal_prepare_current_terminal.
  */
-bool ul_terminal_prepare_current_terminal(int term_width, int term_height);
+void ul_terminal_block_forwarded_signals(void);
+
+/**
+ * Prepare the current TTY for graphics output and start the shell.
+ *
+ * @param term_cols number of columns of the terminal
+ * @param term_rows number of rows of the terminal
+ * @return true on success, false otherwise
+ */
+bool ul_terminal_prepare_current_terminal(int term_cols, int term_rows);
 
 /**
  * Reset the current TTY to text output.
@@ -43,12 +54,26 @@ bool ul_terminal_prepare_current_terminal(int term_width, int term_height);
 void ul_terminal_reset_current_terminal(void);
 
 /**
-* Intepret keyboard input and add it to command buffer
-*/
-char* ul_terminal_update_interpret_buffer();
+ * Get an eventfd that is signalled whenever new shell output is pending. A consumer may block on reading it and
+ * then drain the output with ul_terminal_read_output.
+ *
+ * @return file descriptor, -1 before the terminal has been prepared
+ */
+int ul_terminal_get_output_fd(void);
 
-extern bool term_needs_update;
+/**
+ * Take pending shell output. Safe to call from one consumer thread while the TTY thread keeps reading.
+ *
+ * @param buffer buffer to copy the output into
+ * @param length size of the buffer
+ * @return number of bytes copied, 0 if no output is pending
+ */
+size_t ul_terminal_read_output(char *buffer, size_t length);
 
-extern pthread_mutex_t tty_mutex;
+/**
+ * Hand commands and interrupt / suspend requests collected by the on-screen keyboard over to the TTY
+ * thread. Must be called on the LVGL thread.
+ */
+void ul_terminal_process_keyboard_requests(void);
 
 #endif /* UL_TERMINAL_H */
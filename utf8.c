@@ -0,0 +1,416 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "utf8.h"
+
+#include "cpu.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_SSSE3_VALIDATOR 1
+#endif
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#define HAVE_NEON_VALIDATOR 1
+#endif
+
+
+/**
+ * Defines
+ */
+
+/* Bytes validated per SIMD block */
+#define BLOCK_SIZE 16
+
+/* Error classes of the lookup table validator, see "Validating UTF-8 In Less Than One Instruction Per Byte"
+ * by Keiser and Lemire. A byte pair is invalid if the classes looked up for its two bytes share a bit. */
+#define TOO_SHORT (1 << 0)
+#define TOO_LONG (1 << 1)
+#define OVERLONG_3 (1 << 2)
+#define TOO_LARGE (1 << 3)
+#define SURROGATE (1 << 4)
+#define OVERLONG_2 (1 << 5)
+#define TOO_LARGE_1000 (1 << 6)
+#define OVERLONG_4 (1 << 6)
+#define TWO_CONTS (1 << 7)
+#define CARRY (TOO_SHORT | TOO_LONG | TWO_CONTS)
+
+/* Validator signature, returns the length of the prefix made of complete, valid sequences */
+typedef size_t (*validate_fn)(const uint8_t *data, size_t length);
+
+
+/**
+ * Static variables
+ */
+
+/* Classes by high nibble of the first byte of a pair */
+static const uint8_t byte_1_high_table[16] = {
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+    TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+    TOO_SHORT | OVERLONG_2,
+    TOO_SHORT,
+    TOO_SHORT | OVERLONG_3 | SURROGATE,
+    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4
+};
+
+/* Classes by low nibble of the first byte of a pair */
+static const uint8_t byte_1_low_table[16] = {
+    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+    CARRY | OVERLONG_2,
+    CARRY,
+    CARRY,
+    CARRY | TOO_LARGE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000
+};
+
+/* Classes by high nibble of the second byte of a pair */
+static const uint8_t byte_2_high_table[16] = {
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT
+};
+
+static validate_fn validate_impl = NULL;
+static const char *validate_impl_name = "scalar";
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Feed one byte through the scalar state machine.
+ *
+ * @param decoder decoder state
+ * @param byte byte to decode
+ * @param codepoints buffer for writing up to two codepoints
+ * @return number of codepoints written
+ */
+static size_t decode_byte(ul_utf8_decoder *decoder, uint8_t byte, uint32_t *codepoints);
+
+/**
+ * Decode input that is known to consist of complete, valid sequences.
+ *
+ * @param data bytes to decode
+ * @param length number of bytes
+ * @param codepoints buffer for the decoded codepoints
+ * @return number of codepoints written
+ */
+static size_t decode_valid(const uint8_t *data, size_t length, uint32_t *codepoints);
+
+/**
+ * Get the length of an unfinished sequence at the end of a validated block.
+ *
+ * @param block block of BLOCK_SIZE bytes
+ * @return number of trailing bytes that belong to a sequence continuing past the block
+ */
+static size_t get_incomplete_tail(const uint8_t *block);
+
+#if HAVE_SSSE3_VALIDATOR
+/**
+ * SSSE3 validator working on 16 byte blocks.
+ *
+ * @param data bytes to validate, must start on a sequence boundary
+ * @param length number of bytes
+ * @return length of the prefix made of complete, valid sequences
+ */
+static size_t validate_ssse3(const uint8_t *data, size_t length);
+#endif /* HAVE_SSSE3_VALIDATOR */
+
+#if HAVE_NEON_VALIDATOR
+/**
+ * NEON validator working on 16 byte blocks.
+ *
+ * @param data bytes to validate, must start on a sequence boundary
+ * @param length number of bytes
+ * @return length of the prefix made of complete, valid sequences
+ */
+static size_t validate_neon(const uint8_t *data, size_t length);
+#endif /* HAVE_NEON_VALIDATOR */
+
+
+/**
+ * Static functions
+ */
+
+static size_t decode_byte(ul_utf8_decoder *decoder, uint8_t byte, uint32_t *codepoints) {
+    if (decoder->bytes_needed == 0) {
+        if (byte < 0x80) {
+            codepoints[0] = byte;
+            return 1;
+        }
+        if (byte >= 0xc2 && byte <= 0xdf) {
+            decoder->bytes_needed = 1;
+            decoder->codepoint = byte & 0x1f;
+        } else if (byte >= 0xe0 && byte <= 0xef) {
+            /* Exclude overlong forms and surrogates */
+            if (byte == 0xe0) {
+                decoder->lower_boundary = 0xa0;
+            } else if (byte == 0xed) {
+                decoder->upper_boundary = 0x9f;
+            }
+            decoder->bytes_needed = 2;
+            decoder->codepoint = byte & 0x0f;
+        } else if (byte >= 0xf0 && byte <= 0xf4) {
+            /* Exclude overlong forms and values past U+10FFFF */
+            if (byte == 0xf0) {
+                decoder->lower_boundary = 0x90;
+            } else if (byte == 0xf4) {
+                decoder->upper_boundary = 0x8f;
+            }
+            decoder->bytes_needed = 3;
+            decoder->codepoint = byte & 0x07;
+        } else {
+            codepoints[0] = UL_UTF8_REPLACEMENT_CHARACTER;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (byte < decoder->lower_boundary || byte > decoder->upper_boundary) {
+        /* The sequence ends here and the byte starts over */
+        ul_utf8_decoder_init(decoder);
+        codepoints[0] = UL_UTF8_REPLACEMENT_CHARACTER;
+        return 1 + decode_byte(decoder, byte, codepoints + 1);
+    }
+
+    decoder->lower_boundary = 0x80;
+    decoder->upper_boundary = 0xbf;
+    decoder->codepoint = (decoder->codepoint << 6) | (byte & 0x3f);
+    if (--decoder->bytes_needed > 0) {
+        return 0;
+    }
+
+    codepoints[0] = decoder->codepoint;
+    decoder->codepoint = 0;
+    return 1;
+}
+
+static size_t decode_valid(const uint8_t *data, size_t length, uint32_t *codepoints) {
+    const uint8_t *end = data + length;
+    uint32_t *out = codepoints;
+
+    while (data < end) {
+        uint8_t byte = data[0];
+        if (byte < 0x80) {
+            *out++ = byte;
+            data += 1;
+        } else if (byte < 0xe0) {
+            *out++ = ((uint32_t)(byte & 0x1f) << 6) | (data[1] & 0x3f);
+            data += 2;
+        } else if (byte < 0xf0) {
+            *out++ = ((uint32_t)(byte & 0x0f) << 12) | ((uint32_t)(data[1] & 0x3f) << 6) | (data[2] & 0x3f);
+            data += 3;
+        } else {
+            *out++ = ((uint32_t)(byte & 0x07) << 18) | ((uint32_t)(data[1] & 0x3f) << 12)
+                | ((uint32_t)(data[2] & 0x3f) << 6) | (data[3] & 0x3f);
+            data += 4;
+        }
+    }
+
+    return out - codepoints;
+}
+
+static size_t get_incomplete_tail(const uint8_t *block) {
+    for (size_t i = 1; i <= 3; ++i) {
+        uint8_t byte = block[BLOCK_SIZE - i];
+        if (byte < 0x80) {
+            return 0;
+        }
+        if (byte >= 0xc0) {
+            size_t sequence_length = byte >= 0xf0 ? 4 : (byte >= 0xe0 ? 3 : 2);
+            return sequence_length > i ? i : 0;
+        }
+    }
+    return 0;
+}
+
+#if HAVE_SSSE3_VALIDATOR
+__attribute__((target("ssse3")))
+static size_t validate_ssse3(const uint8_t *data, size_t length) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i nibble_mask = _mm_set1_epi8(0x0f);
+    const __m128i byte_1_high = _mm_loadu_si128((const __m128i *)byte_1_high_table);
+    const __m128i byte_1_low = _mm_loadu_si128((const __m128i *)byte_1_low_table);
+    const __m128i byte_2_high = _mm_loadu_si128((const __m128i *)byte_2_high_table);
+    size_t pos = 0;
+
+    while (length - pos >= BLOCK_SIZE) {
+        __m128i input = _mm_loadu_si128((const __m128i *)(data + pos));
+        if (_mm_movemask_epi8(input) == 0) {
+            pos += BLOCK_SIZE;
+            continue;
+        }
+
+        /* Every block starts on a sequence boundary, so the bytes before it count as ASCII */
+        __m128i prev1 = _mm_alignr_epi8(input, zero, 15);
+        __m128i prev2 = _mm_alignr_epi8(input, zero, 14);
+        __m128i prev3 = _mm_alignr_epi8(input, zero, 13);
+
+        __m128i special_cases = _mm_and_si128(
+            _mm_and_si128(
+                _mm_shuffle_epi8(byte_1_high, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble_mask)),
+                _mm_shuffle_epi8(byte_1_low, _mm_and_si128(prev1, nibble_mask))),
+            _mm_shuffle_epi8(byte_2_high, _mm_and_si128(_mm_srli_epi16(input, 4), nibble_mask)));
+
+        /* Third and fourth bytes of a sequence must be continuation bytes */
+        __m128i must_be_continuation = _mm_and_si128(
+            _mm_or_si128(_mm_subs_epu8(prev2, _mm_set1_epi8(0xe0 - 0x80)),
+                _mm_subs_epu8(prev3, _mm_set1_epi8((char)(0xf0 - 0x80)))),
+            _mm_set1_epi8((char)0x80));
+
+        __m128i error = _mm_xor_si128(must_be_continuation, special_cases);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(error, zero)) != 0xffff) {
+            break;
+        }
+
+        pos += BLOCK_SIZE - get_incomplete_tail(data + pos);
+    }
+
+    return pos;
+}
+#endif /* HAVE_SSSE3_VALIDATOR */
+
+#if HAVE_NEON_VALIDATOR
+static size_t validate_neon(const uint8_t *data, size_t length) {
+    const uint8x16_t zero = vdupq_n_u8(0);
+    const uint8x16_t nibble_mask = vdupq_n_u8(0x0f);
+    const uint8x16_t byte_1_high = vld1q_u8(byte_1_high_table);
+    const uint8x16_t byte_1_low = vld1q_u8(byte_1_low_table);
+    const uint8x16_t byte_2_high = vld1q_u8(byte_2_high_table);
+    size_t pos = 0;
+
+    while (length - pos >= BLOCK_SIZE) {
+        uint8x16_t input = vld1q_u8(data + pos);
+        if (vmaxvq_u8(input) < 0x80) {
+            pos += BLOCK_SIZE;
+            continue;
+        }
+
+        /* Every block starts on a sequence boundary, so the bytes before it count as ASCII */
+        uint8x16_t prev1 = vextq_u8(zero, input, 15);
+        uint8x16_t prev2 = vextq_u8(zero, input, 14);
+        uint8x16_t prev3 = vextq_u8(zero, input, 13);
+
+        uint8x16_t special_cases = vandq_u8(
+            vandq_u8(vqtbl1q_u8(byte_1_high, vshrq_n_u8(prev1, 4)), vqtbl1q_u8(byte_1_low, vandq_u8(prev1, nibble_mask))),
+            vqtbl1q_u8(byte_2_high, vshrq_n_u8(input, 4)));
+
+        /* Third and fourth bytes of a sequence must be continuation bytes */
+        uint8x16_t must_be_continuation = vandq_u8(
+            vorrq_u8(vqsubq_u8(prev2, vdupq_n_u8(0xe0 - 0x80)), vqsubq_u8(prev3, vdupq_n_u8(0xf0 - 0x80))),
+            vdupq_n_u8(0x80));
+
+        if (vmaxvq_u8(veorq_u8(must_be_continuation, special_cases)) != 0) {
+            break;
+        }
+
+        pos += BLOCK_SIZE - get_incomplete_tail(data + pos);
+    }
+
+    return pos;
+}
+#endif /* HAVE_NEON_VALIDATOR */
+
+
+/**
+ * Public functions
+ */
+
+void ul_utf8_init(void) {
+#if HAVE_SSSE3_VALIDATOR
+    if (ul_cpu_has_feature(UL_CPU_FEATURE_SSSE3)) {
+        validate_impl = validate_ssse3;
+        validate_impl_name = "ssse3";
+        return;
+    }
+#endif /* HAVE_SSSE3_VALIDATOR */
+#if HAVE_NEON_VALIDATOR
+    if (ul_cpu_has_feature(UL_CPU_FEATURE_NEON)) {
+        validate_impl = validate_neon;
+        validate_impl_name = "neon";
+        return;
+    }
+#endif /* HAVE_NEON_VALIDATOR */
+    validate_impl = NULL;
+    validate_impl_name = "scalar";
+}
+
+const char *ul_utf8_get_implementation_name(void) {
+    return validate_impl_name;
+}
+
+void ul_utf8_decoder_init(ul_utf8_decoder *decoder) {
+    decoder->codepoint = 0;
+    decoder->bytes_needed = 0;
+    decoder->lower_boundary = 0x80;
+    decoder->upper_boundary = 0xbf;
+}
+
+bool ul_utf8_decoder_is_idle(const ul_utf8_decoder *decoder) {
+    return decoder->bytes_needed == 0;
+}
+
+size_t ul_utf8_decode(ul_utf8_decoder *decoder, const uint8_t *data, size_t length, uint32_t *codepoints) {
+    const uint8_t *p = data;
+    const uint8_t *end = data + length;
+    /* Blocks before this point failed validation and are decoded byte by byte */
+    const uint8_t *next_block = data;
+    uint32_t *out = codepoints;
+
+    while (p < end) {
+        if (validate_impl && decoder->bytes_needed == 0 && p >= next_block && end - p >= BLOCK_SIZE) {
+            size_t valid = validate_impl(p, end - p);
+            out += decode_valid(p, valid, out);
+            p += valid;
+            next_block = p + BLOCK_SIZE;
+            continue;
+        }
+
+        out += decode_byte(decoder, *p, out);
+        ++p;
+    }
+
+    return out - codepoints;
+}
+
+bool ul_utf8_decoder_flush(ul_utf8_decoder *decoder, uint32_t *codepoint) {
+    if (decoder->bytes_needed == 0) {
+        return false;
+    }
+
+    ul_utf8_decoder_init(decoder);
+    *codepoint = UL_UTF8_REPLACEMENT_CHARACTER;
+    return true;
+}
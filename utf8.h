@@ -0,0 +1,91 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_UTF8_H
+#define UL_UTF8_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Codepoint emitted for malformed input */
+#define UL_UTF8_REPLACEMENT_CHARACTER 0xfffd
+
+/* Streaming decoder state, sequences may be split across calls */
+typedef struct {
+    /* Bits of the sequence collected so far */
+    uint32_t codepoint;
+    /* Continuation bytes still expected */
+    uint8_t bytes_needed;
+    /* Range the next continuation byte must lie in, narrower than 0x80 - 0xbf after some lead bytes */
+    uint8_t lower_boundary;
+    uint8_t upper_boundary;
+} ul_utf8_decoder;
+
+/**
+ * Pick the fastest validation code for the running CPU. Must be called before any other thread is started,
+ * without calling it decoding works but doesn't use SIMD.
+ */
+void ul_utf8_init(void);
+
+/**
+ * Get the name of the validator implementation in use, for logging.
+ *
+ * @return implementation name
+ */
+const char *ul_utf8_get_implementation_name(void);
+
+/**
+ * Reset a decoder.
+ *
+ * @param decoder decoder to reset
+ */
+void ul_utf8_decoder_init(ul_utf8_decoder *decoder);
+
+/**
+ * Check whether the decoder is between sequences.
+ *
+ * @param decoder decoder to query
+ * @return true if no sequence has been started but not finished
+ */
+bool ul_utf8_decoder_is_idle(const ul_utf8_decoder *decoder);
+
+/**
+ * Decode bytes into codepoints. Malformed input is replaced with U+FFFD, one per maximal invalid subpart as
+ * recommended by Unicode. An unfinished sequence at the end is kept for the next call.
+ *
+ * @param decoder decoder state
+ * @param data bytes to decode
+ * @param length number of bytes
+ * @param codepoints buffer for the decoded codepoints, must have room for length + 1 values
+ * @return number of codepoints written
+ */
+size_t ul_utf8_decode(ul_utf8_decoder *decoder, const uint8_t *data, size_t length, uint32_t *codepoints);
+
+/**
+ * End the current sequence, e.g. because a control character interrupted it.
+ *
+ * @param decoder decoder state
+ * @param codepoint pointer for writing U+FFFD if a sequence was left unfinished
+ * @return true if a codepoint was written
+ */
+bool ul_utf8_decoder_flush(ul_utf8_decoder *decoder, uint32_t *codepoint);
+
+#endif /* UL_UTF8_H */
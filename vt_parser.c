@@ -0,0 +1,419 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "vt_parser.h"
+
+#include "scan.h"
+
+#include <string.h>
+
+
+/**
+ * Parser states and transition actions, following the DEC compatible state machine described at
+ * https://vt100.net/emu/dec_ansi_parser. C1 controls are not recognised because the shell talks
+ * UTF-8 to us and 0x80-0x9F are continuation bytes there.
+ */
+
+typedef enum {
+    STATE_GROUND,
+    STATE_ESCAPE,
+    STATE_ESCAPE_INTERMEDIATE,
+    STATE_CSI_ENTRY,
+    STATE_CSI_PARAM,
+    STATE_CSI_INTERMEDIATE,
+    STATE_CSI_IGNORE,
+    STATE_DCS_ENTRY,
+    STATE_DCS_PARAM,
+    STATE_DCS_INTERMEDIATE,
+    STATE_DCS_PASSTHROUGH,
+    STATE_DCS_IGNORE,
+    STATE_OSC_STRING,
+    STATE_SOS_PM_APC_STRING,
+    NUM_STATES
+} parser_state;
+
+typedef enum {
+    ACTION_NONE,
+    ACTION_PRINT,
+    ACTION_EXECUTE,
+    ACTION_COLLECT,
+    ACTION_PARAM,
+    ACTION_ESC_DISPATCH,
+    ACTION_CSI_DISPATCH,
+    ACTION_PUT,
+    ACTION_OSC_PUT
+} parser_action;
+
+#define TRANSITION(action, state) ((uint8_t)(((action) << 4) | (state)))
+#define TRANSITION_ACTION(t) ((t) >> 4)
+#define TRANSITION_STATE(t) ((t) & 0x0f)
+
+/* A ground state byte that is simply printed */
+#define GROUND_PRINT TRANSITION(ACTION_PRINT, STATE_GROUND)
+
+
+/**
+ * Static variables
+ */
+
+static uint8_t transitions[NUM_STATES][256];
+static bool are_transitions_built = false;
+
+
+/**
+ * Static prototypes
+ */
+
+/**
+ * Fill the transition table. Only needs to run once per process.
+ */
+static void build_transitions(void);
+
+/**
+ * Set the transition for a range of bytes in one state.
+ *
+ * @param state state to set the transition for
+ * @param first first byte of the range
+ * @param last last byte of the range (inclusive)
+ * @param transition packed action and next state
+ */
+static void set_range(parser_state state, int first, int last, uint8_t transition);
+
+/**
+ * Set the transitions for the C0 control characters that do not cancel a sequence.
+ *
+ * @param state state to set the transitions for
+ * @param transition packed action and next state
+ */
+static void set_c0(parser_state state, uint8_t transition);
+
+/**
+ * Run a transition including the exit action of the old and the entry action of the new state.
+ *
+ * @param parser parser
+ * @param transition packed action and next state
+ * @param byte the byte that caused the transition
+ */
+static void run_transition(ul_vt_parser *parser, uint8_t transition, uint8_t byte);
+
+/**
+ * Emit an action that carries the collected prefix, intermediates and parameters.
+ *
+ * @param parser parser
+ * @param type action type
+ * @param final final byte
+ */
+static void dispatch(ul_vt_parser *parser, ul_vt_action_type type, uint8_t final);
+
+/**
+ * Emit an action that only carries text or a single byte.
+ *
+ * @param parser parser
+ * @param type action type
+ * @param data text or NULL
+ * @param length length of the text
+ * @param byte byte
+ */
+static void emit(ul_vt_parser *parser, ul_vt_action_type type, const char *data, size_t length, uint8_t byte);
+
+/**
+ * Reset the collected prefix, intermediates and parameters.
+ *
+ * @param parser parser
+ */
+static void clear(ul_vt_parser *parser);
+
+
+/**
+ * Static functions
+ */
+
+static void build_transitions(void) {
+    /* Ground */
+    set_c0(STATE_GROUND, TRANSITION(ACTION_EXECUTE, STATE_GROUND));
+    set_range(STATE_GROUND, 0x20, 0x7e, GROUND_PRINT);
+    set_range(STATE_GROUND, 0x7f, 0x7f, TRANSITION(ACTION_NONE, STATE_GROUND));
+    set_range(STATE_GROUND, 0x80, 0xff, GROUND_PRINT);
+
+    /* Escape */
+    set_c0(STATE_ESCAPE, TRANSITION(ACTION_EXECUTE, STATE_ESCAPE));
+    set_range(STATE_ESCAPE, 0x20, 0x2f, TRANSITION(ACTION_COLLECT, STATE_ESCAPE_INTERMEDIATE));
+    set_range(STATE_ESCAPE, 0x30, 0x7e, TRANSITION(ACTION_ESC_DISPATCH, STATE_GROUND));
+    set_range(STATE_ESCAPE, 'P', 'P', TRANSITION(ACTION_NONE, STATE_DCS_ENTRY));
+    set_range(STATE_ESCAPE, 'X', 'X', TRANSITION(ACTION_NONE, STATE_SOS_PM_APC_STRING));
+    set_range(STATE_ESCAPE, '[', '[', TRANSITION(ACTION_NONE, STATE_CSI_ENTRY));
+    set_range(STATE_ESCAPE, ']', ']', TRANSITION(ACTION_NONE, STATE_OSC_STRING));
+    set_range(STATE_ESCAPE, '^', '_', TRANSITION(ACTION_NONE, STATE_SOS_PM_APC_STRING));
+    set_range(STATE_ESCAPE, 0x7f, 0xff, TRANSITION(ACTION_NONE, STATE_ESCAPE));
+
+    /* Escape intermediate */
+    set_c0(STATE_ESCAPE_INTERMEDIATE, TRANSITION(ACTION_EXECUTE, STATE_ESCAPE_INTERMEDIATE));
+    set_range(STATE_ESCAPE_INTERMEDIATE, 0x20, 0x2f, TRANSITION(ACTION_COLLECT, STATE_ESCAPE_INTERMEDIATE));
+    set_range(STATE_ESCAPE_INTERMEDIATE, 0x30, 0x7e, TRANSITION(ACTION_ESC_DISPATCH, STATE_GROUND));
+    set_range(STATE_ESCAPE_INTERMEDIATE, 0x7f, 0xff, TRANSITION(ACTION_NONE, STATE_ESCAPE_INTERMEDIATE));
+
+    /* CSI entry. Sub-parameter separators (':') are treated like ';' so that SGR 38:2:r:g:b works. */
+    set_c0(STATE_CSI_ENTRY, TRANSITION(ACTION_EXECUTE, STATE_CSI_ENTRY));
+    set_range(STATE_CSI_ENTRY, 0x20, 0x2f, TRANSITION(ACTION_COLLECT, STATE_CSI_INTERMEDIATE));
+    set_range(STATE_CSI_ENTRY, 0x30, 0x3b, TRANSITION(ACTION_PARAM, STATE_CSI_PARAM));
+    set_range(STATE_CSI_ENTRY, 0x3c, 0x3f, TRANSITION(ACTION_COLLECT, STATE_CSI_PARAM));
+    set_range(STATE_CSI_ENTRY, 0x40, 0x7e, TRANSITION(ACTION_CSI_DISPATCH, STATE_GROUND));
+    set_range(STATE_CSI_ENTRY, 0x7f, 0xff, TRANSITION(ACTION_NONE, STATE_CSI_ENTRY));
+
+    /* CSI parameters */
+    set_c0(STATE_CSI_PARAM, TRANSITION(ACTION_EXECUTE, STATE_CSI_PARAM));
+    set_range(STATE_CSI_PARAM, 0x20, 0x2f, TRANSITION(ACTION_COLLECT, STATE_CSI_INTERMEDIATE));
+    set_range(STATE_CSI_PARAM, 0x30, 0x3b, TRANSITION(ACTION_PARAM, STATE_CSI_PARAM));
+    set_range(STATE_CSI_PARAM, 0x3c, 0x3f, TRANSITION(ACTION_NONE, STATE_CSI_IGNORE));
+    set_range(STATE_CSI_PARAM, 0x40, 0x7e, TRANSITION(ACTION_CSI_DISPATCH, STATE_GROUND));
+    set_range(STATE_CSI_PARAM, 0x7f, 0xff, TRANSITION(ACTION_NONE, STATE_CSI_PARAM));
+
+    /* CSI intermediates */
+    set_c0(STATE_CSI_INTERMEDIATE, TRANSITION(ACTION_EXECUTE, STATE_CSI_INTERMEDIATE));
+    set_range(STATE_CSI_INTERMEDIATE, 0x20, 0x2f, TRANSITION(ACTION_COLLECT, STATE_CSI_INTERMEDIATE));
+    set_range(STATE_CSI_INTERMEDIATE, 0x30, 0x3f, TRANSITION(ACTION_NONE, STATE_CSI_IGNORE));
+    set_range(STATE_CSI_INTERMEDIATE, 0x40, 0x7e, TRANSITION(ACTION_CSI_DISPATCH, STATE_GROUND));
+    set_range(STATE_CSI_INTERMEDIATE, 0x7f, 0xff, TRANSITION(ACTION_NONE, STATE_CSI_INTERMEDIATE));
+
+    /* Malformed CSI */
+    set_c0(STATE_CSI_IGNORE, TRANSITION(ACTION_EXECUTE, STATE_CSI_IGNORE));
+    set_range(STATE_CSI_IGNORE, 0x20, 0x3f, TRANSITION(ACTION_NONE, STATE_CSI_IGNORE));
+    set_range(STATE_CSI_IGNORE, 0x40, 0x7e, TRANSITION(ACTION_NONE, STATE_GROUND));
+    set_range(STATE_CSI_IGNORE, 0x7f, 0xff, TRANSITION(ACTION_NONE, STATE_CSI_IGNORE));
+
+    /* DCS entry */
+    set_c0(STATE_DCS_ENTRY, TRANSITION(ACTION_NONE, STATE_DCS_ENTRY));
+    set_range(STATE_DCS_ENTRY, 0x20, 0x2f, TRANSITION(ACTION_COLLECT, STATE_DCS_INTERMEDIATE));
+    set_range(STATE_DCS_ENTRY, 0x30, 0x3b, TRANSITION(ACTION_PARAM, STATE_DCS_PARAM));
+    set_range(STATE_DCS_ENTRY, 0x3c, 0x3f, TRANSITION(ACTION_COLLECT, STATE_DCS_PARAM));
+    set_range(STATE_DCS_ENTRY, 0x40, 0x7e, TRANSITION(ACTION_NONE, STATE_DCS_PASSTHROUGH));
+    set_range(STATE_DCS_ENTRY, 0x7f, 0xff, TRANSITION(ACTION_NONE, STATE_DCS_ENTRY));
+
+    /* DCS parameters */
+    set_c0(STATE_DCS_PARAM, TRANSITION(ACTION_NONE, STATE_DCS_PARAM));
+    set_range(STATE_DCS_PARAM, 0x20, 0x2f, TRANSITION(ACTION_COLLECT, STATE_DCS_INTERMEDIATE));
+    set_range(STATE_DCS_PARAM, 0x30, 0x3b, TRANSITION(ACTION_PARAM, STATE_DCS_PARAM));
+    set_range(STATE_DCS_PARAM, 0x3c, 0x3f, TRANSITION(ACTION_NONE, STATE_DCS_IGNORE));
+    set_range(STATE_DCS_PARAM, 0x40, 0x7e, TRANSITION(ACTION_NONE, STATE_DCS_PASSTHROUGH));
+    set_range(STATE_DCS_PARAM, 0x7f, 0xff, TRANSITION(ACTION_NONE, STATE_DCS_PARAM));
+
+    /* DCS intermediates */
+    set_c0(STATE_DCS_INTERMEDIATE, TRANSITION(ACTION_NONE, STATE_DCS_INTERMEDIATE));
+    set_range(STATE_DCS_INTERMEDIATE, 0x20, 0x2f, TRANSITION(ACTION_COLLECT, STATE_DCS_INTERMEDIATE));
+    set_range(STATE_DCS_INTERMEDIATE, 0x30, 0x3f, TRANSITION(ACTION_NONE, STATE_DCS_IGNORE));
+    set_range(STATE_DCS_INTERMEDIATE, 0x40, 0x7e, TRANSITION(ACTION_NONE, STATE_DCS_PASSTHROUGH));
+    set_range(STATE_DCS_INTERMEDIATE, 0x7f, 0xff, TRANSITION(ACTION_NONE, STATE_DCS_INTERMEDIATE));
+
+    /* DCS payload, terminated by ST (ESC \) through the "anywhere" transitions below */
+    set_c0(STATE_DCS_PASSTHROUGH, TRANSITION(ACTION_PUT, STATE_DCS_PASSTHROUGH));
+    set_range(STATE_DCS_PASSTHROUGH, 0x20, 0x7e, TRANSITION(ACTION_PUT, STATE_DCS_PASSTHROUGH));
+    set_range(STATE_DCS_PASSTHROUGH, 0x7f, 0x7f, TRANSITION(ACTION_NONE, STATE_DCS_PASSTHROUGH));
+    set_range(STATE_DCS_PASSTHROUGH, 0x80, 0xff, TRANSITION(ACTION_PUT, STATE_DCS_PASSTHROUGH));
+
+    /* Malformed DCS */
+    set_range(STATE_DCS_IGNORE, 0x00, 0xff, TRANSITION(ACTION_NONE, STATE_DCS_IGNORE));
+
+    /* OSC, terminated by ST or, as in xterm, by BEL */
+    set_c0(STATE_OSC_STRING, TRANSITION(ACTION_NONE, STATE_OSC_STRING));
+    set_range(STATE_OSC_STRING, 0x07, 0x07, TRANSITION(ACTION_NONE, STATE_GROUND));
+    set_range(STATE_OSC_STRING, 0x20, 0xff, TRANSITION(ACTION_OSC_PUT, STATE_OSC_STRING));
+
+    /* SOS, PM and APC strings are consumed and dropped */
+    set_range(STATE_SOS_PM_APC_STRING, 0x00, 0xff, TRANSITION(ACTION_NONE, STATE_SOS_PM_APC_STRING));
+
+    /* Transitions from anywhere */
+    for (int state = 0; state < NUM_STATES; ++state) {
+        set_range(state, 0x18, 0x18, TRANSITION(ACTION_EXECUTE, STATE_GROUND));
+        set_range(state, 0x1a, 0x1a, TRANSITION(ACTION_EXECUTE, STATE_GROUND));
+        set_range(state, 0x1b, 0x1b, TRANSITION(ACTION_NONE, STATE_ESCAPE));
+    }
+
+    are_transitions_built = true;
+}
+
+static void set_range(parser_state state, int first, int last, uint8_t transition) {
+    memset(&(transitions[state][first]), transition, last - first + 1);
+}
+
+static void set_c0(parser_state state, uint8_t transition) {
+    set_range(state, 0x00, 0x17, transition);
+    set_range(state, 0x19, 0x19, transition);
+    set_range(state, 0x1c, 0x1f, transition);
+}
+
+static void run_transition(ul_vt_parser *parser, uint8_t transition, uint8_t byte) {
+    parser_state old_state = parser->state;
+    parser_state new_state = TRANSITION_STATE(transition);
+
+    /* Exit action */
+    if (new_state != old_state) {
+        if (old_state == STATE_OSC_STRING) {
+            emit(parser, UL_VT_ACTION_OSC_DISPATCH, parser->osc, parser->osc_length, 0);
+        } else if (old_state == STATE_DCS_PASSTHROUGH) {
+            emit(parser, UL_VT_ACTION_DCS_UNHOOK, NULL, 0, 0);
+        }
+    }
+
+    /* Transition action */
+    switch ((parser_action)TRANSITION_ACTION(transition)) {
+    case ACTION_NONE:
+        break;
+    case ACTION_PRINT:
+        emit(parser, UL_VT_ACTION_PRINT, (const char *)&byte, 1, 0);
+        break;
+    case ACTION_EXECUTE:
+        emit(parser, UL_VT_ACTION_EXECUTE, NULL, 0, byte);
+        break;
+    case ACTION_COLLECT:
+        if (byte >= 0x3c && byte <= 0x3f) {
+            parser->prefix = (char)byte;
+        } else if (parser->num_intermediates < UL_VT_MAX_INTERMEDIATES) {
+            parser->intermediates[parser->num_intermediates++] = (char)byte;
+        }
+        break;
+    case ACTION_PARAM:
+        if (parser->num_params == 0) {
+            parser->num_params = 1;
+        }
+        if (byte == ';' || byte == ':') {
+            if (parser->num_params < UL_VT_MAX_PARAMS) {
+                parser->num_params++;
+            }
+        } else {
+            uint16_t *param = &(parser->params[parser->num_params - 1]);
+            uint32_t value = *param * 10u + (byte - '0');
+            *param = value > UINT16_MAX ? UINT16_MAX : (uint16_t)value;
+        }
+        break;
+    case ACTION_ESC_DISPATCH:
+        dispatch(parser, UL_VT_ACTION_ESC_DISPATCH, byte);
+        break;
+    case ACTION_CSI_DISPATCH:
+        dispatch(parser, UL_VT_ACTION_CSI_DISPATCH, byte);
+        break;
+    case ACTION_PUT:
+        emit(parser, UL_VT_ACTION_DCS_PUT, NULL, 0, byte);
+        break;
+    case ACTION_OSC_PUT:
+        if (parser->osc_length < UL_VT_MAX_OSC_LENGTH) {
+            parser->osc[parser->osc_length++] = (char)byte;
+        }
+        break;
+    }
+
+    parser->state = new_state;
+
+    /* Entry action */
+    if (new_state != old_state) {
+        switch (new_state) {
+        case STATE_ESCAPE:
+        case STATE_CSI_ENTRY:
+        case STATE_DCS_ENTRY:
+            clear(parser);
+            break;
+        case STATE_OSC_STRING:
+            parser->osc_length = 0;
+            break;
+        case STATE_DCS_PASSTHROUGH:
+            dispatch(parser, UL_VT_ACTION_DCS_HOOK, byte);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+static void dispatch(ul_vt_parser *parser, ul_vt_action_type type, uint8_t final) {
+    ul_vt_action action = {
+        .type = type,
+        .byte = final,
+        .prefix = parser->prefix,
+        .intermediates = parser->intermediates,
+        .num_intermediates = parser->num_intermediates,
+        .params = parser->params,
+        .num_params = parser->num_params
+    };
+    parser->handler(&action, parser->user_data);
+}
+
+static void emit(ul_vt_parser *parser, ul_vt_action_type type, const char *data, size_t length, uint8_t byte) {
+    ul_vt_action action = {
+        .type = type,
+        .data = data,
+        .length = length,
+        .byte = byte
+    };
+    parser->handler(&action, parser->user_data);
+}
+
+static void clear(ul_vt_parser *parser) {
+    parser->prefix = 0;
+    parser->num_intermediates = 0;
+    parser->num_params = 0;
+    memset(parser->params, 0, sizeof(parser->params));
+}
+
+
+/**
+ * Public functions
+ */
+
+void ul_vt_parser_init(ul_vt_parser *parser, ul_vt_handler handler, void *user_data) {
+    if (!are_transitions_built) {
+        build_transitions();
+        ul_scan_init();
+    }
+
+    memset(parser, 0, sizeof(*parser));
+    parser->state = STATE_GROUND;
+    parser->handler = handler;
+    parser->user_data = user_data;
+}
+
+void ul_vt_parser_feed(ul_vt_parser *parser, const char *data, size_t length) {
+    const uint8_t *p = (const uint8_t *)data;
+    const uint8_t *end = p + length;
+
+    while (p < end) {
+        if (parser->state == STATE_GROUND) {
+            /* Fast path: hand whole runs of printable bytes over in one go */
+            const uint8_t *run = p;
+            while (p < end) {
+                p = ul_scan_printable(p, end);
+                if (p == end || *p < 0x80) {
+                    break;
+                }
+                /* Bytes >= 0x80 print as well, they are decoded by the screen */
+                while (p < end && *p >= 0x80) {
+                    ++p;
+                }
+            }
+            if (p > run) {
+                emit(parser, UL_VT_ACTION_PRINT, (const char *)run, p - run, 0);
+            }
+            if (p == end) {
+                break;
+            }
+        }
+
+        run_transition(parser, transitions[parser->state][*p], *p);
+        ++p;
+    }
+}
@@ -0,0 +1,110 @@
+/**
+ * Copyright 2026 FuriLabs
+ *
+ * This file is part of furios-terminal, hereafter referred to as the program.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UL_VT_PARSER_H
+#define UL_VT_PARSER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define UL_VT_MAX_PARAMS 16
+#define UL_VT_MAX_INTERMEDIATES 2
+#define UL_VT_MAX_OSC_LENGTH 512
+
+/* Actions emitted by the parser */
+typedef enum {
+    /* A run of printable characters (data, length) */
+    UL_VT_ACTION_PRINT,
+    /* A C0 control character (byte) */
+    UL_VT_ACTION_EXECUTE,
+    /* An escape sequence (intermediates, final) */
+    UL_VT_ACTION_ESC_DISPATCH,
+    /* A control sequence (prefix, params, intermediates, final) */
+    UL_VT_ACTION_CSI_DISPATCH,
+    /* An operating system command string (data, length) */
+    UL_VT_ACTION_OSC_DISPATCH,
+    /* Start of a device control string (prefix, params, intermediates, final) */
+    UL_VT_ACTION_DCS_HOOK,
+    /* One byte of device control string payload (byte) */
+    UL_VT_ACTION_DCS_PUT,
+    /* End of a device control string */
+    UL_VT_ACTION_DCS_UNHOOK
+} ul_vt_action_type;
+
+/* A parsed action. Pointers are only valid for the duration of the handler call. */
+typedef struct {
+    ul_vt_action_type type;
+    /* Text for PRINT and OSC_DISPATCH */
+    const char *data;
+    size_t length;
+    /* Control character for EXECUTE and DCS_PUT, final byte for dispatches */
+    uint8_t byte;
+    /* Private marker of a CSI / DCS sequence ('?', '>', '<', '=') or 0 */
+    char prefix;
+    /* Intermediate bytes */
+    const char *intermediates;
+    int num_intermediates;
+    /* Numeric parameters, omitted ones are 0 */
+    const uint16_t *params;
+    int num_params;
+} ul_vt_action;
+
+/**
+ * Handle an action emitted by the parser.
+ *
+ * @param action the action
+ * @param user_data user data passed to ul_vt_parser_init
+ */
+typedef void (*ul_vt_handler)(const ul_vt_action *action, void *user_data);
+
+/* Resumable parser state. All fields are private. */
+typedef struct {
+    uint8_t state;
+    char prefix;
+    char intermediates[UL_VT_MAX_INTERMEDIATES];
+    int num_intermediates;
+    uint16_t params[UL_VT_MAX_PARAMS];
+    int num_params;
+    char osc[UL_VT_MAX_OSC_LENGTH];
+    size_t osc_length;
+    ul_vt_handler handler;
+    void *user_data;
+} ul_vt_parser;
+
+/**
+ * Initialise a parser in the ground state.
+ *
+ * @param parser parser to initialise
+ * @param handler function to receive parsed actions
+ * @param user_data pointer handed to the handler
+ */
+void ul_vt_parser_init(ul_vt_parser *parser, ul_vt_handler handler, void *user_data);
+
+/**
+ * Parse a chunk of terminal output. Sequences may be split across calls at any byte.
+ *
+ * @param parser parser to feed
+ * @param data bytes to parse
+ * @param length number of bytes
+ */
+void ul_vt_parser_feed(ul_vt_parser *parser, const char *data, size_t length);
+
+#endif /* UL_VT_PARSER_H */